@@ -21,12 +21,14 @@
 #include "tex.h"
 #include "tex-node.h"
 
-static tex_t	*adult_maga_tex;
-
 stage_t * adult_maga_node_new(stage_conf_t *conf, m4f_t *projection_x, m4f_t *model_x)
 {
-	if (!adult_maga_tex)
-		adult_maga_tex = ansr_tex_new("assets/adult-maga.ans", "assets/adult-maga.mask.ans");
+	tex_t	*tex;
+	stage_t	*s;
+
+	tex = ansr_tex_new("assets/adult-maga.ans", "assets/adult-maga.mask.ans");
+	s = tex_node_new_tex(conf, tex, projection_x, model_x);
+	tex_free(tex);
 
-	return tex_node_new_tex(conf, adult_maga_tex, projection_x, model_x);
+	return s;
 }
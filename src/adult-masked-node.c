@@ -21,12 +21,14 @@
 #include "tex.h"
 #include "tex-node.h"
 
-static tex_t	*adult_masked_tex;
-
 stage_t * adult_masked_node_new(stage_conf_t *conf, m4f_t *projection_x, m4f_t *model_x)
 {
-	if (!adult_masked_tex)
-		adult_masked_tex = ansr_tex_new("assets/adult-masked.ans", "assets/adult-masked.mask.ans");
+	tex_t	*tex;
+	stage_t	*s;
+
+	tex = ansr_tex_new("assets/adult-masked.ans", "assets/adult-masked.mask.ans");
+	s = tex_node_new_tex(conf, tex, projection_x, model_x);
+	tex_free(tex);
 
-	return tex_node_new_tex(conf, adult_masked_tex, projection_x, model_x);
+	return s;
 }
@@ -15,268 +15,583 @@
  */
 
 #include <assert.h>
-#include <stdint.h>
-#include <stdio.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include <ansr.h>
-
 #include "ansr-tex.h"
-#include "cp437.h"
+#include "ansr-view.h"
+#include "bake.h"
+#include "bb2f.h"
+#include "embed.h"
+#include "loader.h"
 #include "macros.h"
 #include "tex.h"
+#include "tex-atlas.h"
+
+
+/* With lod enabled, RGBA sprites hinted w/the largest scale they're drawn at
+ * skip the mip levels bigger than needed for that at the current canvas size.
+ */
+typedef struct ansr_tex_hint_t ansr_tex_hint_t;
+
+struct ansr_tex_hint_t {
+	ansr_tex_hint_t	*next;
+	const char	*path, *mask_path;
+	float		scale;
+};
+
+static ansr_tex_hint_t	*ansr_tex_hints;
+static int		ansr_tex_use_lod;
+static int		ansr_tex_canvas_width, ansr_tex_canvas_height;
 
 
-/* I'm not bothering with a fully-featured SAUCE implementation, but it's
- * necessary to get at its width+lines since a lot of these art editors are
- * really relying on the wrapping at width even with non-80-char widths.
- * So here's a little ad-hoc extractor of just the size for character files.
+/* store the size path + mask_path gets drawn at on the canvas @ res_width x res_height,
+ * 0x0 when unknown.  This is only ever as big as its largest hinted scale.
  */
-static int ansr_get_sauce_dimensions(FILE *f, unsigned *width, unsigned *height)
+void ansr_tex_draw_size(const char *path, const char *mask_path, int *res_width, int *res_height)
 {
-	char		buf[128];
-	long		oldpos;
-	unsigned	w, h;
+	float	scale = 0.f;
 
-	assert(f);
+	assert(path);
+	assert(res_width);
+	assert(res_height);
 
-	oldpos = ftell(f);
-	if (fseek(f, -128, SEEK_END) < 0)
-		goto _err;
+	for (ansr_tex_hint_t *h = ansr_tex_hints; h; h = h->next) {
+		if (STREQ(h->path, path) && STREQ(h->mask_path, mask_path))
+			scale = MAX(scale, h->scale);
+	}
 
-	if (fread(buf, sizeof(buf), 1, f) < 1)
-		goto _err;
+	*res_width = ceilf(scale * ansr_tex_canvas_width);
+	*res_height = ceilf(scale * ansr_tex_canvas_height);
+}
 
-	if (buf[0] != 'S' ||
-	    buf[1] != 'A' ||
-	    buf[2] != 'U' ||
-	    buf[3] != 'C' ||
-	    buf[4] != 'E' ||
-	    buf[5] != '0' ||
-	    buf[6] != '0')
-		goto _err;
 
-	if (buf[94] != 1 ||
-	    buf[95] != 1)
-		goto _err;
+/* how many mip levels a width x height RGBA sprite drawn at draw_width x draw_height
+ * can skip, while staying at least as big as it's drawn.  0 when lod isn't enabled.
+ */
+unsigned ansr_tex_lod(int width, int height, int draw_width, int draw_height)
+{
+	unsigned	lod = 0;
 
-	w = buf[96];
-	w |= ((unsigned)buf[97]) << 8;
+	if (!ansr_tex_use_lod || draw_width <= 0 || draw_height <= 0)
+		return 0;
 
-	h = buf[98];
-	h |= ((unsigned)buf[99]) << 8;
+	while ((width >> (lod + 1)) >= draw_width && (height >> (lod + 1)) >= draw_height)
+		lod++;
 
-	if (width)
-		*width = w;
-	if (height)
-		*height = h;
+	return lod;
+}
 
-	fseek(f, oldpos, SEEK_SET);
 
-	return 0;
+/* trim tex to the opaque bounds of the sprite it was made from, so drawing it
+ * skips the transparent margins.  The drawn bounds get padded by the
+ * filtering's footprint when drawn at draw_width x draw_height, two texels of
+ * the coarser mip level being blended, so the edges still fade out the same.
+ * Unknown draw sizes get a pixel.  The unpadded bounds are kept as the tex's
+ * opaque part, for the collision boxes.
+ */
+static void ansr_tex_trim(tex_t *tex, const ansr_view_bounds_t *bounds, int draw_width, int draw_height)
+{
+	unsigned	pad_x = 1, pad_y = 1, x0, y0, x1, y1;
+	float		sx, sy;
+
+	assert(tex);
+	assert(bounds);
+
+	if (draw_width > 0 && draw_height > 0) {
+		pad_x += 2 * bounds->width / draw_width;
+		pad_y += 2 * bounds->height / draw_height;
+	}
+
+	x0 = bounds->x0 - MIN(bounds->x0, pad_x);
+	y0 = bounds->y0 - MIN(bounds->y0, pad_y);
+	x1 = MIN(bounds->x1 + pad_x, bounds->width);
+	y1 = MIN(bounds->y1 + pad_y, bounds->height);
+	sx = 2.f / bounds->width;
+	sy = 2.f / bounds->height;
+
+	/* pixel rows go down, the quad's y goes up */
+	tex_set_opaque(tex, &(bb2f_t){
+				.min = { bounds->x0 * sx - 1.f, 1.f - bounds->y1 * sy },
+				.max = { bounds->x1 * sx - 1.f, 1.f - bounds->y0 * sy },
+			});
+
+	tex_set_bounds(tex, &(bb2f_t){
+				.min = { x0 * sx - 1.f, 1.f - y1 * sy },
+				.max = { x1 * sx - 1.f, 1.f - y0 * sy },
+			});
+}
+
+
+/* create an RGBA tex from pixels at the lod path + mask_path calls for */
+static tex_t * ansr_tex_new_rgba(const char *path, const char *mask_path, int width, int height, const uint32_t *pixels)
+{
+	int		draw_width, draw_height;
+	unsigned	lod;
 
-_err:
-	fseek(f, oldpos, SEEK_SET);
+	ansr_tex_draw_size(path, mask_path, &draw_width, &draw_height);
+	lod = ansr_tex_lod(width, height, draw_width, draw_height);
 
-	return -1;
+	return tex_new_uploaded(tex_upload_lod(width, height, (const unsigned char *)pixels, lod), width, height, lod);
 }
 
 
-/* foo.ans -> ansr_t * */
-static ansr_t * ansr_from_file(const char *path)
+/* map the baked file for path, returns NULL if there's no usable one */
+static bake_t * ansr_tex_map_baked(const char *path, const char *mask_path)
 {
-	ansr_conf_t	conf = { .screen_width = 80 };
-	char		buf[4096];
-	size_t		len;
-	FILE		*f;
-	ansr_t		*a;
-
-	f = fopen(path, "rb");
-	if (!f)
+	char	*baked_path;
+	bake_t	*bake;
+
+	/* baked files don't record how they were masked, and sars-bake never auto masks */
+	if (mask_path && !strcmp(mask_path, ANSR_VIEW_MASK_AUTO))
 		return NULL;
 
-	debug_if(ansr_get_sauce_dimensions(f, &conf.screen_width, NULL) < 0,
-		"No SAUCE metadata for \"%s\"", path);
+	baked_path = bake_path(path);
+	fatal_if(!baked_path, "unable to allocate baked path for \"%s\"", path);
+
+	bake = bake_map(baked_path, path, mask_path);
+	free(baked_path);
+
+	return bake;
+}
+
 
-	debugf("\"%s\" %u wide", path, conf.screen_width);
+/* try create a tex from a baked file for path, returns NULL if there's no usable one */
+static tex_t * ansr_tex_new_baked(const char *path, const char *mask_path, ansr_view_bounds_t *res_bounds)
+{
+	bake_t	*bake;
+	tex_t	*tex;
 
-	a = ansr_new(&conf, NULL, 0);
-	if (!a) {
-		fclose(f);
+	bake = ansr_tex_map_baked(path, mask_path);
+	if (!bake)
 		return NULL;
+
+	tex = ansr_tex_new_rgba(path, mask_path, bake->width, bake->height, bake->pixels);
+	fatal_if(!tex, "unable to create tex from baked \"%s\"", path);
+	ansr_view_bounds(bake->width, bake->height, bake->pixels, res_bounds);
+	bake_unmap(bake);
+
+	return tex;
+}
+
+
+/* Every tex_t returned by ansr_tex_new() comes from this registry, keyed by
+ * path + mask_path, so each sprite only gets decoded and uploaded once no
+ * matter how many nodes use it.  The registry holds a reference of its own,
+ * which ansr_tex_evict() drops for entries nobody else references anymore.
+ */
+typedef struct ansr_tex_entry_t ansr_tex_entry_t;
+
+struct ansr_tex_entry_t {
+	ansr_tex_entry_t	*next;
+	char			*path, *mask_path;
+	tex_t			*tex;
+	ansr_view_bounds_t	bounds;		/* of the opaque pixels, see ansr_tex_fit() */
+	unsigned		releveling;	/* 1 + lod queued w/the loader, 0 if none, see ansr_tex_fit() */
+	unsigned		packed:1;	/* placed in an atlas page by ansr_tex_pack(), its lod is fixed */
+};
+
+static ansr_tex_entry_t	*ansr_tex_entries;
+static unsigned		ansr_tex_n_loads;
+static ansr_tex_format_t	ansr_tex_fmt;
+
+
+
+/* decode the embedded or baked version of path + mask_path into an ansr_view_t,
+ * returning NULL when neither exists.  This doesn't involve GL so it's safe to
+ * use from any thread.
+ */
+ansr_view_t * ansr_tex_decode_prebuilt(const char *path, const char *mask_path)
+{
+	const embed_asset_t	*asset;
+	ansr_view_t		*v;
+	bake_t			*bake;
+
+	assert(path);
+
+	asset = embed_asset_lookup(path, mask_path);
+	if (asset) {
+		v = embed_asset_view(asset);
+		fatal_if(!v, "unable to create ansr_view from embedded \"%s\"", path);
+
+		return v;
 	}
 
-	while ((len = fread(buf, 1, sizeof(buf), f)) > 0) {
-		if (ansr_write(a, buf, len) < 0) {
-			fclose(f);
-			return ansr_free(a);
-		}
+	bake = ansr_tex_map_baked(path, mask_path);
+	if (bake) {
+		v = malloc(sizeof(ansr_view_t) + bake->width * bake->height * sizeof(uint32_t));
+		fatal_if(!v, "unable to allocate ansr_view for baked \"%s\"", path);
+
+		v->width = bake->width;
+		v->height = bake->height;
+		memcpy(v->pixels, bake->pixels, v->width * v->height * sizeof(uint32_t));
+		bake_unmap(bake);
+
+		return v;
 	}
 
-	fclose(f);
+	return NULL;
+}
+
+
+/* decode path + mask_path into an ansr_view_t without involving GL, so this
+ * is safe to use from any thread.  Same preference order as ansr_tex_new().
+ */
+ansr_view_t * ansr_tex_decode(const char *path, const char *mask_path)
+{
+	ansr_view_t	*v;
+
+	v = ansr_tex_decode_prebuilt(path, mask_path);
+	if (v)
+		return v;
 
-	return a;
+	debugf("no embedded or baked \"%s\", rasterizing", path);
+
+	return ansr_view_new(path, mask_path);
 }
 
 
-typedef struct ansr_view_t {
-	unsigned	width, height;
-	uint32_t	pixels[];
-} ansr_view_t;
+/* decode path + mask_path into an ansr_cells_t for ANSR_TEX_FORMAT_CELLS,
+ * embedded ones are just copied.  Also safe to use from any thread.
+ */
+ansr_cells_t * ansr_tex_decode_cells(const char *path, const char *mask_path)
+{
+	const embed_asset_t	*asset;
+	ansr_cells_t		*c;
+
+	assert(path);
+
+	asset = embed_asset_lookup(path, mask_path);
+	if (asset) {
+		c = embed_asset_cells(asset);
+		fatal_if(!c, "unable to create ansr_cells from embedded \"%s\"", path);
+
+		return c;
+	}
+
+	return ansr_cells_new(path, mask_path);
+}
 
 
-static void cp437_draw_glyph(ansr_view_t *view, int x, int y, uint32_t bg, uint32_t fg, unsigned char c)
+/* load an .ans file and render out to a texture,
+ * preferring the version embedded in the executable, then a baked version
+ * produced by sars-bake, before finally resorting to rasterizing the file.
+ * If the loader has been asked to load this path + mask_path, its result
+ * gets used instead.  The bounds of its opaque pixels are stored @ res_bounds.
+ */
+static tex_t * ansr_tex_load(const char *path, const char *mask_path, ansr_view_bounds_t *res_bounds)
 {
-	int			CY = c / 32, CX = c % 32;
-	const unsigned char	*src = &cp437.pixel_data[(8 + CY * 16) * cp437.width + (8 + CX * 9)];
-
-	assert(view);
-	assert(x >= 0 && y >= 0);
-
-	/* the glyphs are 8x16 but within the cp437->pixel_data they're rendered as 9x16 with the horizontal
-	 * separator, and for the glyphs where the right-most column was right-extended their 8th column is
-	 * pre-duplicated out to the divider into the right.  Here I'll just treat everything as 8x16 and not
-	 * render any separator into the surface - which might actually be visibly wrong vs. viewing ANSI on
-	 * a DOS PC VGA console, we'll see.
-	 * cp437->pixel_data also has 8 bytes of padding on all sides.
-	 */
-	for (int v = 0; v < 16; v++) {
-		for (int u = 0; u < 8; u++) {
-			uint32_t	*dest;
-
-			dest = &view->pixels[(y * 16 + v) * view->width + (x * 8 + u)];
-			if (src[u])
-				*dest = fg;
-			else
-				*dest = bg;
-		}
-		src += cp437.width;
+	const embed_asset_t	*asset;
+	tex_t			*tex;
+	ansr_view_t		*v;
+	int			waited;
+
+	tex = loader_take_tex(path, mask_path, res_bounds, &waited);
+	if (tex) {
+		if (waited)
+			ansr_tex_n_loads++;
+
+		return tex;
+	}
+
+	ansr_tex_n_loads++;
+
+	if (ansr_tex_fmt == ANSR_TEX_FORMAT_CELLS) {
+		ansr_cells_t	*c;
+
+		c = ansr_tex_decode_cells(path, mask_path);
+		tex = tex_new_cells(c->width, c->height, c->cells);
+		fatal_if(!tex, "unable to create tex from ansr_cells \"%s\"", path);
+		ansr_cells_bounds(c, res_bounds);
+		ansr_cells_free(c);
+
+		return tex;
+	}
+
+	/* baked files can go straight from the mapping to tex_new() when loading synchronously */
+	asset = embed_asset_lookup(path, mask_path);
+	if (!asset && ansr_tex_fmt == ANSR_TEX_FORMAT_RGBA) {
+		tex = ansr_tex_new_baked(path, mask_path, res_bounds);
+		if (tex)
+			return tex;
+	}
+
+	v = ansr_tex_decode(path, mask_path);
+	if (ansr_tex_fmt == ANSR_TEX_FORMAT_INDEXED) {
+		unsigned char	*indices;
+
+		indices = ansr_view_indices(v);
+		fatal_if(!indices, "unable to allocate indices for \"%s\"", path);
+		tex = tex_new_indexed(v->width, v->height, indices);
+		free(indices);
+	} else {
+		tex = ansr_tex_new_rgba(path, mask_path, v->width, v->height, v->pixels);
 	}
+	fatal_if(!tex, "unable to create tex from ansr_view \"%s\"", path);
+	ansr_view_bounds(v->width, v->height, v->pixels, res_bounds);
+	ansr_view_free(v);
+
+	return tex;
 }
 
 
-/* ansr_t * -> cp437 -> ansr_view_t * */
-static ansr_view_t * ansr_view_as_cp437(ansr_t *ansr)
+/* the lod e's tex calls for on the current canvas */
+static unsigned ansr_tex_entry_lod(ansr_tex_entry_t *e)
 {
-	unsigned	width;
-	ansr_view_t	*v;
+	int	width, height, draw_width, draw_height;
 
-	assert(ansr);
-	assert(ansr->rows);
+	ansr_tex_draw_size(e->path, e->mask_path, &draw_width, &draw_height);
+	tex_size(e->tex, &width, &height);
 
-	width = ansr->conf.screen_width;
+	return ansr_tex_lod(width, height, draw_width, draw_height);
+}
+
+
+/* fit e's tex to the size it's drawn at on the current canvas, trimming it
+ * and having the loader reupload it in the background if the lod it calls
+ * for has changed.  It keeps getting drawn at its current lod until then.
+ */
+static void ansr_tex_fit(ansr_tex_entry_t *e)
+{
+	int		draw_width, draw_height;
+	unsigned	lod;
+
+	ansr_tex_draw_size(e->path, e->mask_path, &draw_width, &draw_height);
+	ansr_tex_trim(e->tex, &e->bounds, draw_width, draw_height);
+
+	if (ansr_tex_fmt != ANSR_TEX_FORMAT_RGBA || e->packed)
+		return;
+
+	lod = ansr_tex_entry_lod(e);
+	if (lod == tex_lod(e->tex) || lod + 1 == e->releveling)
+		return;
+
+	debugf("relevelling \"%s\" to lod %u", e->path, lod);
+
+	e->releveling = lod + 1;
+	loader_queue_relevel(e->path, e->mask_path);
+}
 
-	for (size_t r = 0; r < ansr->height; r++) {
-		if (ansr->rows[r] && ansr->rows[r]->width > width)
-			width = ansr->rows[r]->width;
+
+/* called by the loader from the GL thread when a relevel queued by
+ * ansr_tex_fit() has been uploaded at lod as texture name.  Returns 1 if
+ * the texture got taken for path + mask_path's tex, 0 if it's not wanted
+ * anymore, like when the canvas got resized again in the meantime.
+ */
+int ansr_tex_releveled(const char *path, const char *mask_path, unsigned name, unsigned lod)
+{
+	ansr_tex_entry_t	*e;
+
+	assert(path);
+
+	for (e = ansr_tex_entries; e; e = e->next) {
+		if (STREQ(e->path, path) && STREQ(e->mask_path, mask_path))
+			break;
 	}
 
-	v = calloc(1, sizeof(ansr_view_t) + width * 8 * ansr->height * 16 * sizeof(uint32_t));
-	if (!v)
-		return NULL;
+	if (!e)
+		return 0;
+
+	if (lod + 1 == e->releveling)
+		e->releveling = 0;
+
+	if (e->packed || lod != ansr_tex_entry_lod(e) || lod == tex_lod(e->tex))
+		return 0;
 
-	v->width = width * 8;
-	v->height = ansr->height * 16;
+	tex_reupload(e->tex, name, lod);
+
+	return 1;
+}
 
+
+/* get a reference to the tex_t for an .ans file + mask_path (may be NULL),
+ * loading it on first use.  Release it with tex_free().
+ */
+tex_t * ansr_tex_new(const char *path, const char *mask_path)
+{
+	ansr_tex_entry_t	*e;
+
+	assert(path);
+
+	for (e = ansr_tex_entries; e; e = e->next) {
+		if (STREQ(e->path, path) && STREQ(e->mask_path, mask_path))
+			return tex_ref(e->tex);
+	}
+
+	e = calloc(1, sizeof(ansr_tex_entry_t));
+	fatal_if(!e, "unable to allocate ansr_tex entry for \"%s\"", path);
+
+	e->path = strdup(path);
+	fatal_if(!e->path, "unable to duplicate path \"%s\"", path);
+
+	if (mask_path) {
+		e->mask_path = strdup(mask_path);
+		fatal_if(!e->mask_path, "unable to duplicate mask path \"%s\"", mask_path);
+	}
+
+	e->tex = ansr_tex_load(path, mask_path, &e->bounds);
+	e->next = ansr_tex_entries;
+	ansr_tex_entries = e;
+
+	/* the loader may have uploaded it for a different canvas size */
+	ansr_tex_fit(e);
+
+	return tex_ref(e->tex);
+}
+
+
+/* drop the registry's reference on textures nobody else is referencing,
+ * e.g. after the stage nodes using them have been freed.  Their next
+ * ansr_tex_new() will load them again.  Returns the number evicted.
+ */
+unsigned ansr_tex_evict(void)
 {
-	uint32_t	dims[8] = {
-				0xff000000,
-				0xff0000aa,
-				0xff00aa00,
-				0xff0055aa,
-				0xffaa0000,
-				0xffaa00aa,
-				0xffaaaa00,
-				0xffaaaaaa,
-			};
-	uint32_t	brights[8] = {
-				0xff555555,
-				0xff5555ff,
-				0xff55ff55,
-				0xff55ffff,
-				0xffff5555,
-				0xffff55ff,
-				0xffffff55,
-				0xffffffff,
-			};
-
-	for (size_t r = 0; r < ansr->height; r++) {
-		ansr_row_t	*row = ansr->rows[r];
-
-		if (row) {
-			for (size_t c = 0; c < row->width; c++) {
-				uint32_t	fg, bg;
-
-				if (!row->cols[c].code)
-					continue;
-
-				if (row->cols[c].disp_state.attrs.bold) {
-					fg = brights[row->cols[c].disp_state.colors.fg];
-				} else {
-					fg = dims[row->cols[c].disp_state.colors.fg];
-				}
-				bg = dims[row->cols[c].disp_state.colors.bg];
-
-				if (row->cols[c].disp_state.attrs.invert) {
-					uint32_t	tmp;
-
-					tmp = fg;
-					fg = bg;
-					bg = tmp;
-				}
-
-				cp437_draw_glyph(v, c, r, bg, fg, row->cols[c].code);
-			}
+	unsigned	n = 0;
+
+	for (ansr_tex_entry_t *e, **prev = &ansr_tex_entries; (e = *prev);) {
+		if (tex_refcnt(e->tex) > 1) {
+			prev = &e->next;
+			continue;
 		}
+
+		debugf("evicting \"%s\"", e->path);
+
+		*prev = e->next;
+		tex_free(e->tex);
+		free(e->path);
+		free(e->mask_path);
+		free(e);
+		n++;
 	}
+
+	return n;
 }
 
-	return v;
+
+/* returns how many ansr_tex_new() calls had to do any decoding or uploading
+ * themselves, rather than just taking a tex the loader already finished.
+ */
+unsigned ansr_tex_loads(void)
+{
+	return ansr_tex_n_loads;
 }
 
 
-/* load an .ans file and render out to a texture returned as tex_t */
-tex_t * ansr_tex_new(const char *path, const char *mask_path)
+/* select the texture format sprites get loaded as, must be set before loading anything */
+void ansr_tex_set_format(ansr_tex_format_t format)
 {
-	tex_t		*tex;
-	ansr_t		*a;
-	ansr_view_t	*v;
+	assert(!ansr_tex_entries);
 
-	a = ansr_from_file(path);
-	fatal_if(!a, "unable to create ansr from .ans \"%s\"", path);
+	ansr_tex_fmt = format;
+}
 
-	v = ansr_view_as_cp437(a);
-	fatal_if(!v, "unable to create ansr_view from ansr \"%s\"", path);
-	ansr_free(a);
 
-	if (mask_path) {
-		/* when a mask is provided, only black pixels in the mask will be
-		 * transparent in the output - everything else will be made 100% opaque.
-		 */
-		ansr_view_t	*mv;
-
-		a = ansr_from_file(mask_path);
-		fatal_if(!a, "unable to create ansr from .ans \"%s\"", mask_path);
-		mv = ansr_view_as_cp437(a);
-		fatal_if(!mv, "unable to create ansr_view from ansr \"%s\"", mask_path);
-		ansr_free(a);
-
-		fatal_if(v->width != mv->width || v->height != mv->height,
-			"\"%s\" <-> \"%s\" mask dimensions mismatch", path, mask_path);
-
-		for (size_t i = 0; i < v->width * v->height; i++) {
-			if (!(mv->pixels[i] & 0xffffff))
-				v->pixels[i] = 0; /* transparent pixel, toss out any color info */
-			else
-				v->pixels[i] |= 0xff000000; /* opaque pixel, set the alpha bits */
+ansr_tex_format_t ansr_tex_format(void)
+{
+	return ansr_tex_fmt;
+}
+
+
+/* enable skipping the mip levels of hinted RGBA sprites which are bigger than
+ * they get drawn, must be set before loading anything.
+ */
+void ansr_tex_set_lod(int lod)
+{
+	assert(!ansr_tex_entries);
+
+	ansr_tex_use_lod = lod;
+}
+
+
+/* set the canvas size sprites get drawn on for the lod and trimming, any
+ * loaded sprites calling for a different lod at the new size get reuploaded
+ * by the loader.
+ */
+void ansr_tex_set_canvas_size(int width, int height)
+{
+	ansr_tex_canvas_width = width;
+	ansr_tex_canvas_height = height;
+
+	for (ansr_tex_entry_t *e = ansr_tex_entries; e; e = e->next)
+		ansr_tex_fit(e);
+}
+
+
+/* hint that path + mask_path gets drawn at most at scale relative to the canvas,
+ * the strings must remain valid for the life of the process.  Hints must be given
+ * before the sprite gets queued with the loader.
+ */
+void ansr_tex_hint_scale(const char *path, const char *mask_path, float scale)
+{
+	ansr_tex_hint_t	*h;
+
+	assert(path);
+
+	h = calloc(1, sizeof(ansr_tex_hint_t));
+	fatal_if(!h, "unable to allocate hint for \"%s\"", path);
+
+	h->path = path;
+	h->mask_path = mask_path;
+	h->scale = scale;
+	h->next = ansr_tex_hints;
+	ansr_tex_hints = h;
+}
+
+
+/* pack every loaded sprite into atlas pages, so drawing them doesn't need a
+ * texture bind per sprite.  The sprites get decoded again for this, so it's
+ * meant to be done once after loading.  Atlased sprites keep their full mip
+ * chains regardless of the lod.  Cells textures are tiny already and stay
+ * as they are, as do sprites too big for a page, which keep following the lod.
+ */
+void ansr_tex_pack(tex_atlas_stats_t *res_stats)
+{
+	ansr_view_t	**views;
+	unsigned char	**indices;
+	tex_atlas_t	*atlas;
+	unsigned	n = 0, i = 0;
+
+	assert(res_stats);
+
+	*res_stats = (tex_atlas_stats_t){ 0 };
+	if (ansr_tex_fmt == ANSR_TEX_FORMAT_CELLS)
+		return;
+
+	for (ansr_tex_entry_t *e = ansr_tex_entries; e; e = e->next)
+		n++;
+
+	views = calloc(n, sizeof(*views));
+	indices = calloc(n, sizeof(*indices));
+	fatal_if(n && (!views || !indices), "unable to allocate views for packing");
+
+	atlas = tex_atlas_new(ansr_tex_fmt == ANSR_TEX_FORMAT_INDEXED);
+	for (ansr_tex_entry_t *e = ansr_tex_entries; e; e = e->next, i++) {
+		if (e->packed)
+			continue;
+
+		views[i] = ansr_tex_decode(e->path, e->mask_path);
+		if (ansr_tex_fmt == ANSR_TEX_FORMAT_INDEXED) {
+			indices[i] = ansr_view_indices(views[i]);
+			fatal_if(!indices[i], "unable to allocate indices for \"%s\"", e->path);
+			tex_atlas_add(atlas, e->tex, views[i]->width, views[i]->height, indices[i]);
+		} else {
+			tex_atlas_add(atlas, e->tex, views[i]->width, views[i]->height, views[i]->pixels);
 		}
-		free(mv);
 	}
 
-	tex = tex_new(v->width, v->height, (const unsigned char *)v->pixels);
-	fatal_if(!tex, "unable to create tex from ansr_view \"%s\"", path);
-	free(v);
+	tex_atlas_pack(atlas, res_stats);
+	for (ansr_tex_entry_t *e = ansr_tex_entries; e; e = e->next)
+		e->packed |= tex_atlas_packed(atlas, e->tex);
+	tex_atlas_free(atlas);
 
-	return tex;
+	for (i = 0; i < n; i++) {
+		ansr_view_free(views[i]);
+		free(indices[i]);
+	}
+	free(views);
+	free(indices);
+
+	debugf("packed %u sprites into %u atlas pages, %.1f%% occupied, %u standalone",
+		res_stats->n_packed, res_stats->n_pages, res_stats->occupancy * 100.f, res_stats->n_standalone);
 }
@@ -19,8 +19,31 @@
 
 #include <stddef.h> /* mask_path may be NULL and plenty of listings using this practically only include this */
 
+typedef struct ansr_cells_t ansr_cells_t;
+typedef struct ansr_view_t ansr_view_t;
+typedef struct tex_atlas_stats_t tex_atlas_stats_t;
 typedef struct tex_t tex_t;
 
+typedef enum ansr_tex_format_t {
+	ANSR_TEX_FORMAT_RGBA,		/* rasterized pixels, the default */
+	ANSR_TEX_FORMAT_INDEXED,	/* rasterized palette indices, see tex_new_indexed() */
+	ANSR_TEX_FORMAT_CELLS,		/* cell grids expanded on the GPU, see tex_new_cells() */
+} ansr_tex_format_t;
+
+ansr_view_t * ansr_tex_decode_prebuilt(const char *path, const char *mask_path);
+ansr_view_t * ansr_tex_decode(const char *path, const char *mask_path);
+ansr_cells_t * ansr_tex_decode_cells(const char *path, const char *mask_path);
 tex_t * ansr_tex_new(const char *path, const char *mask_path);
+unsigned ansr_tex_evict(void);
+unsigned ansr_tex_loads(void);
+void ansr_tex_set_format(ansr_tex_format_t format);
+ansr_tex_format_t ansr_tex_format(void);
+void ansr_tex_set_lod(int lod);
+void ansr_tex_set_canvas_size(int width, int height);
+void ansr_tex_hint_scale(const char *path, const char *mask_path, float scale);
+void ansr_tex_draw_size(const char *path, const char *mask_path, int *res_width, int *res_height);
+unsigned ansr_tex_lod(int width, int height, int draw_width, int draw_height);
+void ansr_tex_pack(tex_atlas_stats_t *res_stats);
+int ansr_tex_releveled(const char *path, const char *mask_path, unsigned name, unsigned lod);
 
 #endif
@@ -0,0 +1,931 @@
+/*
+ *  Copyright (C) 2022 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ansr.h>
+
+#include "ansr-view.h"
+#include "cp437.h"
+#include "cp437-bits.h"
+#include "macros.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+
+/* the VGA colors in ansr_view_t pixel format, dims followed by brights */
+const uint32_t	ansr_view_palette[16] = {
+			0xff000000,
+			0xff0000aa,
+			0xff00aa00,
+			0xff0055aa,
+			0xffaa0000,
+			0xffaa00aa,
+			0xffaaaa00,
+			0xffaaaaaa,
+
+			0xff555555,
+			0xff5555ff,
+			0xff55ff55,
+			0xff55ffff,
+			0xffff5555,
+			0xffff55ff,
+			0xffffff55,
+			0xffffffff,
+		};
+
+
+/* I'm not bothering with a fully-featured SAUCE implementation, but it's
+ * necessary to get at its width+lines since a lot of these art editors are
+ * really relying on the wrapping at width even with non-80-char widths.
+ * So here's a little ad-hoc extractor of just the size for character files.
+ */
+static int ansr_get_sauce_dimensions(FILE *f, unsigned *width, unsigned *height)
+{
+	char		buf[128];
+	long		oldpos;
+	unsigned	w, h;
+
+	assert(f);
+
+	oldpos = ftell(f);
+	if (fseek(f, -128, SEEK_END) < 0)
+		goto _err;
+
+	if (fread(buf, sizeof(buf), 1, f) < 1)
+		goto _err;
+
+	if (buf[0] != 'S' ||
+	    buf[1] != 'A' ||
+	    buf[2] != 'U' ||
+	    buf[3] != 'C' ||
+	    buf[4] != 'E' ||
+	    buf[5] != '0' ||
+	    buf[6] != '0')
+		goto _err;
+
+	if (buf[94] != 1 ||
+	    buf[95] != 1)
+		goto _err;
+
+	w = buf[96];
+	w |= ((unsigned)buf[97]) << 8;
+
+	h = buf[98];
+	h |= ((unsigned)buf[99]) << 8;
+
+	if (width)
+		*width = w;
+	if (height)
+		*height = h;
+
+	fseek(f, oldpos, SEEK_SET);
+
+	return 0;
+
+_err:
+	fseek(f, oldpos, SEEK_SET);
+
+	return -1;
+}
+
+
+/* ANSI art mostly repeats a handful of (code, fg, bg) cells like runs of
+ * spaces and solid blocks, so rasterized cells get memoized in a small
+ * direct-mapped cache and just copied a row at a time when seen again.
+ */
+#define ANSR_VIEW_TILE_CACHE_BITS	6
+#define ANSR_VIEW_TILE_CACHE_SIZE	(1 << ANSR_VIEW_TILE_CACHE_BITS)
+#define ANSR_VIEW_TILE_KEY_VALID	0x80000000u
+
+typedef struct ansr_view_tile_cache_t {
+	uint32_t	keys[ANSR_VIEW_TILE_CACHE_SIZE];	/* code | fg << 8 | bg << 12 | ANSR_VIEW_TILE_KEY_VALID */
+	uint32_t	tiles[ANSR_VIEW_TILE_CACHE_SIZE][16 * 8];
+	unsigned	hits, misses;
+} ansr_view_tile_cache_t;
+
+typedef enum ansr_view_job_phase_t {
+	ANSR_VIEW_JOB_PHASE_PARSE,	/* feeding the .ans file to ansr */
+	ANSR_VIEW_JOB_PHASE_RASTER,	/* rasterizing glyph rows */
+	ANSR_VIEW_JOB_PHASE_DONE,
+} ansr_view_job_phase_t;
+
+/* When masked, the mask gets parsed first into a 1bpp coverage map of 16
+ * bytes per cell, one per glyph row w/bit 7 leftmost, just like cp437_bits.
+ * The image is then rasterized straight to its final alpha in a single pass.
+ */
+struct ansr_view_job_t {
+	const char		*path, *mask_path;
+	ansr_view_job_phase_t	phase;
+	unsigned		masking:1;	/* parsing/rasterizing mask_path into cover */
+	unsigned		auto_mask:1;	/* coverage comes from the image's background color */
+
+	FILE			*f;
+	ansr_t			*ansr;
+	size_t			row;
+
+	unsigned		cover_width, cover_height;	/* in cells */
+	unsigned char		*cover;
+	unsigned		auto_key;	/* palette index of the background when auto_mask */
+
+	ansr_view_t		*view;
+	ansr_view_tile_cache_t	tiles;
+};
+
+
+/* foo.ans -> ansr_t *, the file gets fed into it incrementally by the caller */
+static ansr_t * ansr_open(const char *path, FILE **res_f)
+{
+	ansr_conf_t	conf = { .screen_width = 80 };
+	FILE		*f;
+	ansr_t		*a;
+
+	f = fopen(path, "rb");
+	if (!f)
+		return NULL;
+
+	debug_if(ansr_get_sauce_dimensions(f, &conf.screen_width, NULL) < 0,
+		"No SAUCE metadata for \"%s\"", path);
+
+	debugf("\"%s\" %u wide", path, conf.screen_width);
+
+	a = ansr_new(&conf, NULL, 0);
+	if (!a) {
+		fclose(f);
+		return NULL;
+	}
+
+	*res_f = f;
+
+	return a;
+}
+
+
+static ansr_view_rasterizer_t	ansr_view_rasterizer = ANSR_VIEW_RASTERIZER_TILES;
+
+
+/* the original rasterizer working directly from cp437.h's image, kept as a
+ * reference for sars-bake --bench to compare against.
+ */
+static void cp437_draw_glyph_reference(ansr_view_t *view, int x, int y, uint32_t bg, uint32_t fg, unsigned char c, const unsigned char *cover)
+{
+	int			CY = c / 32, CX = c % 32;
+	const unsigned char	*src = &cp437.pixel_data[(8 + CY * 16) * cp437.width + (8 + CX * 9)];
+
+	assert(view);
+	assert(x >= 0 && y >= 0);
+	assert(cover);
+
+	/* the glyphs are 8x16 but within the cp437->pixel_data they're rendered as 9x16 with the horizontal
+	 * separator, and for the glyphs where the right-most column was right-extended their 8th column is
+	 * pre-duplicated out to the divider into the right.  Here I'll just treat everything as 8x16 and not
+	 * render any separator into the surface - which might actually be visibly wrong vs. viewing ANSI on
+	 * a DOS PC VGA console, we'll see.
+	 * cp437->pixel_data also has 8 bytes of padding on all sides.
+	 */
+	for (int v = 0; v < 16; v++) {
+		for (int u = 0; u < 8; u++) {
+			uint32_t	*dest;
+
+			dest = &view->pixels[(y * 16 + v) * view->width + (x * 8 + u)];
+			if (!(cover[v] & (0x80 >> u)))
+				*dest = 0;
+			else if (src[u])
+				*dest = fg;
+			else
+				*dest = bg;
+		}
+		src += cp437.width;
+	}
+}
+
+
+/* expand one bit-packed glyph row into 8 pixels @ dest, zeroing the pixels
+ * whose bits are clear in cover.
+ */
+static inline void cp437_draw_glyph_row(uint32_t *dest, uint32_t bg, uint32_t fg, unsigned char bits, unsigned char cover)
+{
+#if defined(__SSE2__)
+	const __m128i	lo_bits = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+	const __m128i	hi_bits = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+	__m128i		b = _mm_set1_epi32(bits);
+	__m128i		c = _mm_set1_epi32(cover);
+	__m128i		vbg = _mm_set1_epi32(bg);
+	__m128i		diff = _mm_set1_epi32(fg ^ bg);
+	__m128i		lo, hi, lo_cover, hi_cover;
+
+	/* bg ^ ((fg ^ bg) & mask) selects fg for the set bits */
+	lo = _mm_cmpeq_epi32(_mm_and_si128(b, lo_bits), lo_bits);
+	hi = _mm_cmpeq_epi32(_mm_and_si128(b, hi_bits), hi_bits);
+	lo_cover = _mm_cmpeq_epi32(_mm_and_si128(c, lo_bits), lo_bits);
+	hi_cover = _mm_cmpeq_epi32(_mm_and_si128(c, hi_bits), hi_bits);
+	_mm_storeu_si128((__m128i *)&dest[0], _mm_and_si128(lo_cover, _mm_xor_si128(vbg, _mm_and_si128(diff, lo))));
+	_mm_storeu_si128((__m128i *)&dest[4], _mm_and_si128(hi_cover, _mm_xor_si128(vbg, _mm_and_si128(diff, hi))));
+#elif defined(__ARM_NEON)
+	static const uint32_t	lo_bits[4] = { 0x80, 0x40, 0x20, 0x10 };
+	static const uint32_t	hi_bits[4] = { 0x08, 0x04, 0x02, 0x01 };
+	uint32x4_t		b = vdupq_n_u32(bits);
+	uint32x4_t		c = vdupq_n_u32(cover);
+	uint32x4_t		vbg = vdupq_n_u32(bg);
+	uint32x4_t		vfg = vdupq_n_u32(fg);
+	uint32x4_t		vlo = vld1q_u32(lo_bits), vhi = vld1q_u32(hi_bits);
+
+	vst1q_u32(&dest[0], vandq_u32(vtstq_u32(c, vlo), vbslq_u32(vtstq_u32(b, vlo), vfg, vbg)));
+	vst1q_u32(&dest[4], vandq_u32(vtstq_u32(c, vhi), vbslq_u32(vtstq_u32(b, vhi), vfg, vbg)));
+#else
+	/* 8 bits of a 0/1 lane selection per nibble */
+	static const uint32_t	nibble_masks[16][4] = {
+#define M(_b) ((_b) ? 0xffffffffu : 0u)
+#define N(_n) { M((_n) & 8), M((_n) & 4), M((_n) & 2), M((_n) & 1) }
+				N(0x0), N(0x1), N(0x2), N(0x3), N(0x4), N(0x5), N(0x6), N(0x7),
+				N(0x8), N(0x9), N(0xa), N(0xb), N(0xc), N(0xd), N(0xe), N(0xf),
+#undef N
+#undef M
+			};
+	const uint32_t		*hi = nibble_masks[bits >> 4], *lo = nibble_masks[bits & 0xf];
+	const uint32_t		*hi_cover = nibble_masks[cover >> 4], *lo_cover = nibble_masks[cover & 0xf];
+	uint32_t		diff = fg ^ bg;
+
+	dest[0] = (bg ^ (diff & hi[0])) & hi_cover[0];
+	dest[1] = (bg ^ (diff & hi[1])) & hi_cover[1];
+	dest[2] = (bg ^ (diff & hi[2])) & hi_cover[2];
+	dest[3] = (bg ^ (diff & hi[3])) & hi_cover[3];
+	dest[4] = (bg ^ (diff & lo[0])) & lo_cover[0];
+	dest[5] = (bg ^ (diff & lo[1])) & lo_cover[1];
+	dest[6] = (bg ^ (diff & lo[2])) & lo_cover[2];
+	dest[7] = (bg ^ (diff & lo[3])) & lo_cover[3];
+#endif
+}
+
+
+static void cp437_draw_glyph(ansr_view_t *view, int x, int y, uint32_t bg, uint32_t fg, unsigned char c, const unsigned char *cover)
+{
+	const unsigned char	*bits = cp437_bits[c];
+	uint32_t		*dest;
+
+	assert(view);
+	assert(x >= 0 && y >= 0);
+	assert(cover);
+
+	/* see cp437_draw_glyph_reference() regarding the missing 9th column */
+	dest = &view->pixels[y * 16 * view->width + x * 8];
+	for (int v = 0; v < 16; v++) {
+		cp437_draw_glyph_row(dest, bg, fg, bits[v], cover[v]);
+		dest += view->width;
+	}
+}
+
+
+/* draw glyph c w/palette colors fg+bg at cell x,y via the tile cache */
+static void cp437_draw_glyph_cached(ansr_view_t *view, ansr_view_tile_cache_t *tiles, int x, int y, unsigned bg, unsigned fg, unsigned char c, const unsigned char *cover)
+{
+	uint32_t		key = c | fg << 8 | bg << 12 | ANSR_VIEW_TILE_KEY_VALID;
+	unsigned		idx = (key * 2654435761u) >> (32 - ANSR_VIEW_TILE_CACHE_BITS);
+	const unsigned char	*bits = cp437_bits[c];
+	uint32_t		*tile = tiles->tiles[idx], *dest;
+
+	assert(view);
+	assert(tiles);
+	assert(fg < 16 && bg < 16);
+	assert(cover);
+
+	if (tiles->keys[idx] == key) {
+		tiles->hits++;
+	} else {
+		for (int v = 0; v < 16; v++)
+			cp437_draw_glyph_row(&tile[v * 8], ansr_view_palette[bg], ansr_view_palette[fg], bits[v], 0xff);
+
+		tiles->keys[idx] = key;
+		tiles->misses++;
+	}
+
+	/* the tiles are uncovered, so partially covered rows just get expanded again */
+	dest = &view->pixels[y * 16 * view->width + x * 8];
+	for (int v = 0; v < 16; v++) {
+		if (cover[v] == 0xff)
+			memcpy(dest, &tile[v * 8], 8 * sizeof(uint32_t));
+		else
+			cp437_draw_glyph_row(dest, ansr_view_palette[bg], ansr_view_palette[fg], bits[v], cover[v]);
+		dest += view->width;
+	}
+}
+
+
+/* width of ansr in cells, any rows wider than the SAUCE width widen it */
+static unsigned ansr_cells_width(ansr_t *ansr)
+{
+	unsigned	width;
+
+	assert(ansr);
+	assert(ansr->rows);
+
+	width = ansr->conf.screen_width;
+
+	for (size_t r = 0; r < ansr->height; r++) {
+		if (ansr->rows[r] && ansr->rows[r]->width > width)
+			width = ansr->rows[r]->width;
+	}
+
+	return width;
+}
+
+
+/* allocate an ansr_view_t big enough for the cp437 rasterization of ansr */
+static ansr_view_t * ansr_view_new_cp437(ansr_t *ansr)
+{
+	unsigned	width;
+	ansr_view_t	*v;
+
+	width = ansr_cells_width(ansr);
+
+	v = calloc(1, sizeof(ansr_view_t) + width * 8 * ansr->height * 16 * sizeof(uint32_t));
+	if (!v)
+		return NULL;
+
+	v->width = width * 8;
+	v->height = ansr->height * 16;
+
+	return v;
+}
+
+
+/* get the fg+bg palette indices for a cell w/bold and invert applied */
+static void ansr_col_colors(const ansr_col_t *col, unsigned *res_fg, unsigned *res_bg)
+{
+	unsigned	fg, bg;
+
+	if (col->disp_state.attrs.bold) {
+		fg = 8 + col->disp_state.colors.fg;
+	} else {
+		fg = col->disp_state.colors.fg;
+	}
+	bg = col->disp_state.colors.bg;
+
+	if (col->disp_state.attrs.invert) {
+		unsigned	tmp;
+
+		tmp = fg;
+		fg = bg;
+		bg = tmp;
+	}
+
+	*res_fg = fg;
+	*res_bg = bg;
+}
+
+
+/* 1bpp coverage of a glyph row where pixels of palette index key are uncovered */
+static inline unsigned char cp437_cover_row(unsigned char bits, unsigned fg, unsigned bg, unsigned key)
+{
+	return (fg != key ? bits : 0) | (bg != key ? ~bits : 0);
+}
+
+
+/* mask ansr rows [r_start, r_end) -> 1bpp job->cover, black being uncovered */
+static void ansr_view_cover_rows(ansr_view_job_t *job, size_t r_start, size_t r_end)
+{
+	ansr_t	*ansr = job->ansr;
+
+	assert(r_end <= ansr->height);
+
+	for (size_t r = r_start; r < r_end; r++) {
+		ansr_row_t	*row = ansr->rows[r];
+
+		if (!row)
+			continue;
+
+		for (size_t c = 0; c < row->width; c++) {
+			const unsigned char	*bits = cp437_bits[row->cols[c].code];
+			unsigned char		*cover = &job->cover[(r * job->cover_width + c) * 16];
+			unsigned		fg, bg;
+
+			if (!row->cols[c].code)
+				continue;
+
+			ansr_col_colors(&row->cols[c], &fg, &bg);
+			for (int v = 0; v < 16; v++)
+				cover[v] = cp437_cover_row(bits[v], fg, bg, 0);
+		}
+	}
+}
+
+
+/* image ansr rows [r_start, r_end) -> cp437 -> job->view, w/coverage applied */
+static void ansr_view_draw_rows(ansr_view_job_t *job, size_t r_start, size_t r_end)
+{
+	static const unsigned char	opaque[16] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+						       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+	ansr_view_t			*view = job->view;
+	ansr_t				*ansr = job->ansr;
+	size_t				width = view->width / 8;
+
+	assert(r_end <= ansr->height);
+
+	for (size_t r = r_start; r < r_end; r++) {
+		ansr_row_t	*row = ansr->rows[r];
+
+		for (size_t c = 0; c < width; c++) {
+			const unsigned char	*cover = opaque;
+			unsigned char		auto_cover[16];
+			unsigned		fg, bg;
+
+			if (job->cover)
+				cover = &job->cover[(r * job->cover_width + c) * 16];
+
+			if (!row || c >= row->width || !row->cols[c].code) {
+				/* empty cells are left transparent, unless covered by a mask which makes them opaque black */
+				if (job->cover) {
+					uint32_t	*dest = &view->pixels[r * 16 * view->width + c * 8];
+
+					for (int v = 0; v < 16; v++, dest += view->width)
+						cp437_draw_glyph_row(dest, ansr_view_palette[0], ansr_view_palette[0], 0, cover[v]);
+				}
+				continue;
+			}
+
+			ansr_col_colors(&row->cols[c], &fg, &bg);
+
+			if (job->auto_mask) {
+				const unsigned char	*bits = cp437_bits[row->cols[c].code];
+
+				for (int v = 0; v < 16; v++)
+					auto_cover[v] = cp437_cover_row(bits[v], fg, bg, job->auto_key);
+				cover = auto_cover;
+			}
+
+			switch (ansr_view_rasterizer) {
+			case ANSR_VIEW_RASTERIZER_REFERENCE:
+				cp437_draw_glyph_reference(view, c, r, ansr_view_palette[bg], ansr_view_palette[fg], row->cols[c].code, cover);
+				break;
+
+			case ANSR_VIEW_RASTERIZER_BITS:
+				cp437_draw_glyph(view, c, r, ansr_view_palette[bg], ansr_view_palette[fg], row->cols[c].code, cover);
+				break;
+
+			case ANSR_VIEW_RASTERIZER_TILES:
+				cp437_draw_glyph_cached(view, &job->tiles, c, r, bg, fg, row->cols[c].code, cover);
+				break;
+
+			default:
+				assert(0);
+			}
+		}
+	}
+}
+
+
+/* palette index of the image's top-left pixel, taken as its background for auto masking */
+static unsigned ansr_auto_key(ansr_t *ansr)
+{
+	ansr_row_t	*row = ansr->height ? ansr->rows[0] : NULL;
+	unsigned	fg, bg;
+
+	if (!row || !row->width || !row->cols[0].code)
+		return 0;
+
+	ansr_col_colors(&row->cols[0], &fg, &bg);
+
+	return (cp437_bits[row->cols[0].code][0] & 0x80) ? fg : bg;
+}
+
+
+/* mask_path, or ANSR_VIEW_MASK_AUTO when it names a mask file which doesn't exist */
+static const char * ansr_mask_path(const char *mask_path)
+{
+	FILE	*f;
+
+	if (!mask_path || !strcmp(mask_path, ANSR_VIEW_MASK_AUTO))
+		return mask_path;
+
+	f = fopen(mask_path, "rb");
+	if (!f) {
+		debugf("no mask \"%s\", masking the background color instead", mask_path);
+
+		return ANSR_VIEW_MASK_AUTO;
+	}
+	fclose(f);
+
+	return mask_path;
+}
+
+
+/* start loading an .ans file into an ansr_view_t, applying mask_path if non-NULL.
+ * mask_path may be ANSR_VIEW_MASK_AUTO for making the image's background color
+ * transparent when there's no mask file, the top-left pixel being the background,
+ * which is also what happens when mask_path doesn't exist.
+ * Nothing happens until ansr_view_job_step() gets called, so the work can be spread
+ * out over time by callers which can't block, like the loader in single-threaded
+ * builds.  The strings must remain valid for the life of the job.
+ */
+ansr_view_job_t * ansr_view_job_new(const char *path, const char *mask_path)
+{
+	ansr_view_job_t	*job;
+
+	assert(path);
+
+	job = calloc(1, sizeof(ansr_view_job_t));
+	fatal_if(!job, "unable to allocate ansr_view_job_t for \"%s\"", path);
+
+	job->path = path;
+	job->mask_path = ansr_mask_path(mask_path);
+	job->auto_mask = (job->mask_path && !strcmp(job->mask_path, ANSR_VIEW_MASK_AUTO));
+	job->masking = (job->mask_path && !job->auto_mask);
+
+	return job;
+}
+
+
+/* perform one bounded step of the job; feeding a chunk of a file to ansr,
+ * or rasterizing up to n_rows glyph rows of the mask or image.
+ * Returns 1 when the job is done and ansr_view_job_finish() may be called.
+ */
+int ansr_view_job_step(ansr_view_job_t *job, unsigned n_rows)
+{
+	const char	*path;
+
+	assert(job);
+	assert(n_rows > 0);
+
+	path = job->masking ? job->mask_path : job->path;
+
+	switch (job->phase) {
+	case ANSR_VIEW_JOB_PHASE_PARSE: {
+		char	buf[4096];
+		size_t	len;
+
+		if (!job->ansr) {
+			job->ansr = ansr_open(path, &job->f);
+			fatal_if(!job->ansr, "unable to create ansr from .ans \"%s\"", path);
+		}
+
+		len = fread(buf, 1, sizeof(buf), job->f);
+		if (len > 0) {
+			fatal_if(ansr_write(job->ansr, buf, len) < 0,
+				"unable to create ansr from .ans \"%s\"", path);
+			break;
+		}
+
+		fclose(job->f);
+		job->f = NULL;
+
+		if (job->masking) {
+			job->cover_width = ansr_cells_width(job->ansr);
+			job->cover_height = job->ansr->height;
+			job->cover = calloc(job->cover_width * job->cover_height, 16);
+			fatal_if(!job->cover, "unable to allocate coverage for \"%s\"", path);
+		} else {
+			job->view = ansr_view_new_cp437(job->ansr);
+			fatal_if(!job->view, "unable to create ansr_view from ansr \"%s\"", path);
+
+			fatal_if(job->cover &&
+				 (job->view->width != job->cover_width * 8 || job->view->height != job->cover_height * 16),
+				"\"%s\" <-> \"%s\" mask dimensions mismatch", job->path, job->mask_path);
+
+			if (job->auto_mask)
+				job->auto_key = ansr_auto_key(job->ansr);
+		}
+
+		job->row = 0;
+		job->phase = ANSR_VIEW_JOB_PHASE_RASTER;
+		break;
+	}
+
+	case ANSR_VIEW_JOB_PHASE_RASTER: {
+		size_t	r_end = MIN(job->row + n_rows, job->ansr->height);
+
+		if (job->masking)
+			ansr_view_cover_rows(job, job->row, r_end);
+		else
+			ansr_view_draw_rows(job, job->row, r_end);
+
+		job->row = r_end;
+		if (job->row < job->ansr->height)
+			break;
+
+		job->ansr = ansr_free(job->ansr);
+
+		if (job->masking) {
+			job->masking = 0;
+			job->phase = ANSR_VIEW_JOB_PHASE_PARSE;
+		} else {
+			job->phase = ANSR_VIEW_JOB_PHASE_DONE;
+		}
+		break;
+	}
+
+	case ANSR_VIEW_JOB_PHASE_DONE:
+		break;
+
+	default:
+		assert(0);
+	}
+
+	return job->phase == ANSR_VIEW_JOB_PHASE_DONE;
+}
+
+
+/* free the job, returning its ansr_view_t which the caller now owns,
+ * with its tile cache statistics stored @ res_stats if non-NULL.
+ */
+ansr_view_t * ansr_view_job_finish(ansr_view_job_t *job, ansr_view_stats_t *res_stats)
+{
+	ansr_view_t	*v;
+
+	assert(job);
+	assert(job->phase == ANSR_VIEW_JOB_PHASE_DONE);
+
+	if (res_stats) {
+		res_stats->tile_hits = job->tiles.hits;
+		res_stats->tile_misses = job->tiles.misses;
+	}
+
+	v = job->view;
+	free(job->cover);
+	free(job);
+
+	return v;
+}
+
+
+/* load an .ans file and render out to an ansr_view_t, applying mask_path if non-NULL */
+ansr_view_t * ansr_view_new(const char *path, const char *mask_path)
+{
+	ansr_view_job_t	*job;
+
+	assert(path);
+
+	job = ansr_view_job_new(path, mask_path);
+	while (!ansr_view_job_step(job, UINT_MAX));
+
+	return ansr_view_job_finish(job, NULL);
+}
+
+
+ansr_view_t * ansr_view_free(ansr_view_t *view)
+{
+	free(view);
+
+	return NULL;
+}
+
+
+/* convert view's pixels to ansr_view_palette[] indices, w/ANSR_VIEW_TRANSPARENT
+ * for the transparent ones.  Returns a newly allocated array of a byte per pixel,
+ * or NULL when out of memory.
+ */
+unsigned char * ansr_view_indices(const ansr_view_t *view)
+{
+	unsigned char	*indices, index = ANSR_VIEW_TRANSPARENT;
+	uint32_t	last = 0;
+
+	assert(view);
+
+	indices = malloc(view->width * view->height);
+	if (!indices)
+		return NULL;
+
+	/* runs of the same color are the norm, so only search the palette on changes */
+	for (size_t i = 0; i < view->width * view->height; i++) {
+		uint32_t	pixel = view->pixels[i];
+
+		if (pixel != last) {
+			last = pixel;
+			index = ANSR_VIEW_TRANSPARENT;
+
+			if (pixel & 0xff000000) {
+				for (index = 0; index < NELEMS(ansr_view_palette) && ansr_view_palette[index] != pixel; index++);
+				fatal_if(index == NELEMS(ansr_view_palette), "pixel %08x isn't in the palette", pixel);
+			}
+		}
+
+		indices[i] = index;
+	}
+
+	return indices;
+}
+
+
+/* find the bounds of the opaque pixels in a width x height sprite, which is
+ * all of it when nothing's opaque.  This takes the pixels rather than an
+ * ansr_view_t so baked sprites can use it straight from their mapping.
+ */
+void ansr_view_bounds(unsigned width, unsigned height, const uint32_t *pixels, ansr_view_bounds_t *res_bounds)
+{
+	unsigned	x0 = width, y0 = height, x1 = 0, y1 = 0;
+
+	assert(pixels);
+	assert(res_bounds);
+
+	for (unsigned y = 0; y < height; y++) {
+		const uint32_t	*row = &pixels[y * width];
+		unsigned	l, r;
+
+		for (l = 0; l < width && !(row[l] & 0xff000000); l++);
+		if (l == width)
+			continue;
+
+		for (r = width; !(row[r - 1] & 0xff000000); r--);
+
+		x0 = MIN(x0, l);
+		x1 = MAX(x1, r);
+		y0 = MIN(y0, y);
+		y1 = y + 1;
+	}
+
+	if (x0 >= x1)
+		x0 = y0 = 0, x1 = width, y1 = height;
+
+	*res_bounds = (ansr_view_bounds_t){ .width = width, .height = height, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1 };
+}
+
+
+/* parse all of an .ans file into an ansr_t */
+static ansr_t * ansr_load(const char *path)
+{
+	char	buf[4096];
+	size_t	len;
+	ansr_t	*ansr;
+	FILE	*f;
+
+	ansr = ansr_open(path, &f);
+	fatal_if(!ansr, "unable to create ansr from .ans \"%s\"", path);
+
+	while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+		fatal_if(ansr_write(ansr, buf, len) < 0,
+			"unable to create ansr from .ans \"%s\"", path);
+
+	fclose(f);
+
+	return ansr;
+}
+
+
+/* the cell at row r column c of ansr, NULL if empty */
+static const ansr_col_t * ansr_cell(ansr_t *ansr, size_t r, size_t c)
+{
+	ansr_row_t	*row = r < ansr->height ? ansr->rows[r] : NULL;
+
+	if (!row || c >= row->width || !row->cols[c].code)
+		return NULL;
+
+	return &row->cols[c];
+}
+
+
+/* load an .ans file into an ansr_cells_t, applying mask_path if non-NULL.
+ * This covers exactly the same pixels as ansr_view_new() does, and being just
+ * the parse w/no rasterizing there's no need for a resumable job.
+ */
+ansr_cells_t * ansr_cells_new(const char *path, const char *mask_path)
+{
+	ansr_t		*ansr, *mask = NULL;
+	unsigned	width, auto_key = 0;
+	int		auto_mask;
+	ansr_cells_t	*cells;
+
+	assert(path);
+
+	mask_path = ansr_mask_path(mask_path);
+	auto_mask = (mask_path && !strcmp(mask_path, ANSR_VIEW_MASK_AUTO));
+	if (mask_path && !auto_mask)
+		mask = ansr_load(mask_path);
+
+	ansr = ansr_load(path);
+	width = ansr_cells_width(ansr);
+
+	fatal_if(mask && (ansr_cells_width(mask) != width || mask->height != ansr->height),
+		"\"%s\" <-> \"%s\" mask dimensions mismatch", path, mask_path);
+
+	if (auto_mask)
+		auto_key = ansr_auto_key(ansr);
+
+	cells = calloc(1, sizeof(ansr_cells_t) + width * ansr->height * sizeof(uint32_t));
+	fatal_if(!cells, "unable to allocate ansr_cells for \"%s\"", path);
+
+	cells->width = width;
+	cells->height = ansr->height;
+
+	for (size_t r = 0; r < ansr->height; r++) {
+		for (size_t c = 0; c < width; c++) {
+			const ansr_col_t	*col = ansr_cell(ansr, r, c);
+			unsigned		code = 0, fg = 0, bg = 0;
+			unsigned		cover_code = 0, cover_flags = 0;
+
+			if (col) {
+				code = col->code;
+				ansr_col_colors(col, &fg, &bg);
+			}
+
+			if (mask) {
+				const ansr_col_t	*mcol = ansr_cell(mask, r, c);
+
+				if (mcol) {
+					unsigned	mfg, mbg;
+
+					ansr_col_colors(mcol, &mfg, &mbg);
+					cover_code = mcol->code;
+					cover_flags = (mfg ? ANSR_CELLS_COVER_FG : 0) | (mbg ? ANSR_CELLS_COVER_BG : 0);
+				}
+			} else if (col) {
+				cover_code = code;
+				cover_flags = ANSR_CELLS_COVER_FG | ANSR_CELLS_COVER_BG;
+
+				if (auto_mask)
+					cover_flags = (fg != auto_key ? ANSR_CELLS_COVER_FG : 0) | (bg != auto_key ? ANSR_CELLS_COVER_BG : 0);
+			}
+
+			cells->cells[r * width + c] = ANSR_CELLS_PACK(code, fg, bg, cover_code, cover_flags);
+		}
+	}
+
+	ansr_free(ansr);
+	if (mask)
+		ansr_free(mask);
+
+	return cells;
+}
+
+
+ansr_cells_t * ansr_cells_free(ansr_cells_t *cells)
+{
+	free(cells);
+
+	return NULL;
+}
+
+
+/* like ansr_view_bounds() but from the cells' cover glyphs, in pixels */
+void ansr_cells_bounds(const ansr_cells_t *cells, ansr_view_bounds_t *res_bounds)
+{
+	unsigned	width, height, x0, y0, x1 = 0, y1 = 0;
+
+	assert(cells);
+	assert(res_bounds);
+
+	width = cells->width * 8;
+	height = cells->height * 16;
+	x0 = width;
+	y0 = height;
+
+	for (unsigned y = 0; y < cells->height; y++) {
+		for (unsigned x = 0; x < cells->width; x++) {
+			uint32_t		cell = cells->cells[y * cells->width + x];
+			const unsigned char	*bits = cp437_bits[(cell >> 16) & 0xff];
+			unsigned		flags = cell >> 24;
+
+			if (!flags)
+				continue;
+
+			for (unsigned v = 0; v < 16; v++) {
+				unsigned char	row = cp437_cover_row(bits[v], flags & ANSR_CELLS_COVER_FG, flags & ANSR_CELLS_COVER_BG, 0);
+				unsigned	l, r;
+
+				if (!row)
+					continue;
+
+				/* bit 7 is the leftmost pixel */
+				for (l = 0; !(row & (0x80 >> l)); l++);
+				for (r = 8; !(row & (0x100 >> r)); r--);
+
+				x0 = MIN(x0, x * 8 + l);
+				x1 = MAX(x1, x * 8 + r);
+				y0 = MIN(y0, y * 16 + v);
+				y1 = MAX(y1, y * 16 + v + 1);
+			}
+		}
+	}
+
+	if (x0 >= x1)
+		x0 = y0 = 0, x1 = width, y1 = height;
+
+	*res_bounds = (ansr_view_bounds_t){ .width = width, .height = height, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1 };
+}
+
+
+/* select the rasterizer for subsequent rasterizing, for benchmarking */
+void ansr_view_set_rasterizer(ansr_view_rasterizer_t rasterizer)
+{
+	ansr_view_rasterizer = rasterizer;
+}
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2022 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ANSR_VIEW_H
+#define _ANSR_VIEW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CPU-side rasterization of .ans files into RGBA pixels, kept free of GL
+ * so it's usable from build-time tools like sars-bake.
+ */
+typedef struct ansr_view_t {
+	unsigned	width, height;
+	uint32_t	pixels[];
+} ansr_view_t;
+
+typedef struct ansr_view_job_t ansr_view_job_t;
+
+/* The cell grid of an .ans file, for reconstructing its pixels on the GPU
+ * instead of uploading them, see tex_new_cells().  Each cell is packed as
+ * the bytes { code, fg | bg << 4, cover code, cover flags }; the pixels set
+ * in the cover code's glyph are opaque when ANSR_CELLS_COVER_FG is in the
+ * flags, the clear ones when ANSR_CELLS_COVER_BG is.  Masked cells carry the
+ * mask's glyph, unmasked ones are simply fully covered or empty.
+ */
+typedef struct ansr_cells_t {
+	unsigned	width, height;	/* in cells */
+	uint32_t	cells[];
+} ansr_cells_t;
+
+#define ANSR_CELLS_COVER_FG	0x1
+#define ANSR_CELLS_COVER_BG	0x2
+#define ANSR_CELLS_PACK(_code, _fg, _bg, _cover_code, _cover_flags)	\
+	((uint32_t)(_code) | (uint32_t)((_fg) | (_bg) << 4) << 8 |	\
+	 (uint32_t)(_cover_code) << 16 | (uint32_t)(_cover_flags) << 24)
+
+/* mask_path for deriving the mask from the image's background color */
+#define ANSR_VIEW_MASK_AUTO	"<auto>"
+
+typedef struct ansr_view_stats_t {
+	unsigned	tile_hits, tile_misses;
+} ansr_view_stats_t;
+
+typedef enum ansr_view_rasterizer_t {
+	ANSR_VIEW_RASTERIZER_REFERENCE,	/* original per-pixel from cp437.h */
+	ANSR_VIEW_RASTERIZER_BITS,	/* bit-packed glyphs w/SIMD row expansion */
+	ANSR_VIEW_RASTERIZER_TILES,	/* BITS + memoized cells, the default */
+} ansr_view_rasterizer_t;
+
+/* the bounding rectangle of a sprite's opaque pixels, x1/y1 exclusive */
+typedef struct ansr_view_bounds_t {
+	unsigned	width, height;	/* of the whole sprite */
+	unsigned	x0, y0, x1, y1;
+} ansr_view_bounds_t;
+
+/* ansr_view_palette[] index for transparent pixels, in ansr_view_indices() */
+#define ANSR_VIEW_TRANSPARENT	16
+
+extern const uint32_t	ansr_view_palette[16];
+
+ansr_view_t * ansr_view_new(const char *path, const char *mask_path);
+ansr_view_t * ansr_view_free(ansr_view_t *view);
+unsigned char * ansr_view_indices(const ansr_view_t *view);
+void ansr_view_bounds(unsigned width, unsigned height, const uint32_t *pixels, ansr_view_bounds_t *res_bounds);
+void ansr_view_set_rasterizer(ansr_view_rasterizer_t rasterizer);
+
+ansr_cells_t * ansr_cells_new(const char *path, const char *mask_path);
+ansr_cells_t * ansr_cells_free(ansr_cells_t *cells);
+void ansr_cells_bounds(const ansr_cells_t *cells, ansr_view_bounds_t *res_bounds);
+
+ansr_view_job_t * ansr_view_job_new(const char *path, const char *mask_path);
+int ansr_view_job_step(ansr_view_job_t *job, unsigned n_rows);
+ansr_view_t * ansr_view_job_finish(ansr_view_job_t *job, ansr_view_stats_t *res_stats);
+
+#endif
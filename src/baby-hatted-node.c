@@ -21,12 +21,14 @@
 #include "tex.h"
 #include "tex-node.h"
 
-static tex_t	*baby_hatted_tex;
-
 stage_t * baby_hatted_node_new(stage_conf_t *conf, m4f_t *projection_x, m4f_t *model_x)
 {
-	if (!baby_hatted_tex)
-		baby_hatted_tex = ansr_tex_new("assets/baby-hatted.ans", "assets/baby-hatted.mask.ans");
+	tex_t	*tex;
+	stage_t	*s;
+
+	tex = ansr_tex_new("assets/baby-hatted.ans", "assets/baby-hatted.mask.ans");
+	s = tex_node_new_tex(conf, tex, projection_x, model_x);
+	tex_free(tex);
 
-	return tex_node_new_tex(conf, baby_hatted_tex, projection_x, model_x);
+	return s;
 }
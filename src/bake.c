@@ -0,0 +1,199 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Baked textures are just the ansr_view_t pixels of an .ans (+ .mask.ans)
+ * pair written out verbatim behind a tiny header, produced at build time by
+ * sars-bake.  At runtime they get mmap()d and handed straight to tex_new(),
+ * skipping the libansr parse and glyph rasterization entirely.
+ *
+ * The pixels are stored in host byte order, the same as ansr_view_t, so a
+ * baked file isn't portable across endianness.  That's fine for something
+ * produced by the build for the build.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ansr-view.h"
+#include "bake.h"
+#include "macros.h"
+
+#define BAKE_MAGIC	"SARSBAKE"
+#define BAKE_VERSION	1
+
+typedef struct bake_header_t {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	width, height;
+	uint32_t	reserved;
+} bake_header_t;
+
+
+/* "assets/foo.ans" -> "assets/foo.bake", caller must free() the result */
+char * bake_path(const char *path)
+{
+	size_t	len;
+	char	*res;
+
+	assert(path);
+
+	len = strlen(path);
+	if (len > CSTRLEN(".ans") && !strcmp(&path[len - CSTRLEN(".ans")], ".ans"))
+		len -= CSTRLEN(".ans");
+
+	res = malloc(len + sizeof(".bake"));
+	if (!res)
+		return NULL;
+
+	memcpy(res, path, len);
+	memcpy(&res[len], ".bake", sizeof(".bake"));
+
+	return res;
+}
+
+
+/* returns -errno on failure, 0 on success */
+int bake_write(const char *path, const ansr_view_t *view)
+{
+	bake_header_t	hdr = {
+				.magic = BAKE_MAGIC,
+				.version = BAKE_VERSION,
+			};
+	FILE		*f;
+
+	assert(path);
+	assert(view);
+
+	hdr.width = view->width;
+	hdr.height = view->height;
+
+	f = fopen(path, "wb");
+	if (!f)
+		return -errno;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, f) < 1 ||
+	    fwrite(view->pixels, view->width * sizeof(uint32_t), view->height, f) < view->height) {
+		int	r = -errno;
+
+		fclose(f);
+		unlink(path);
+
+		return r;
+	}
+
+	if (fclose(f) != 0) {
+		int	r = -errno;
+
+		unlink(path);
+
+		return r;
+	}
+
+	return 0;
+}
+
+
+/* is the baked file at least as new as src_path? */
+static int bake_is_fresh(const struct stat *st, const char *src_path)
+{
+	struct stat	src_st;
+
+	if (!src_path)
+		return 1;
+
+	/* the sources don't have to be around for the baked file to be used */
+	if (stat(src_path, &src_st) < 0)
+		return 1;
+
+	return st->st_mtime >= src_st.st_mtime;
+}
+
+
+/* map a baked file at path, returns NULL if it's missing, invalid, or older than
+ * either of src_path or src_mask_path (which may be NULL).
+ */
+bake_t * bake_map(const char *path, const char *src_path, const char *src_mask_path)
+{
+	const bake_header_t	*hdr;
+	struct stat		st;
+	bake_t			*bake;
+	void			*map;
+	int			fd;
+
+	assert(path);
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) < 0 ||
+	    st.st_size < sizeof(bake_header_t) ||
+	    !bake_is_fresh(&st, src_path) ||
+	    !bake_is_fresh(&st, src_mask_path)) {
+		close(fd);
+
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	hdr = map;
+	if (memcmp(hdr->magic, BAKE_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != BAKE_VERSION ||
+	    st.st_size != sizeof(bake_header_t) + (size_t)hdr->width * hdr->height * sizeof(uint32_t)) {
+		warn_if(1, "ignoring invalid baked file \"%s\"", path);
+		munmap(map, st.st_size);
+
+		return NULL;
+	}
+
+	bake = calloc(1, sizeof(bake_t));
+	if (!bake) {
+		munmap(map, st.st_size);
+
+		return NULL;
+	}
+
+	bake->width = hdr->width;
+	bake->height = hdr->height;
+	bake->pixels = (const uint32_t *)&hdr[1];
+	bake->map = map;
+	bake->map_len = st.st_size;
+
+	return bake;
+}
+
+
+bake_t * bake_unmap(bake_t *bake)
+{
+	if (!bake)
+		return NULL;
+
+	munmap(bake->map, bake->map_len);
+	free(bake);
+
+	return NULL;
+}
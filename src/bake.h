@@ -0,0 +1,38 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BAKE_H
+#define _BAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ansr_view_t ansr_view_t;
+
+typedef struct bake_t {
+	unsigned	width, height;
+	const uint32_t	*pixels;
+
+	void		*map;
+	size_t		map_len;
+} bake_t;
+
+char * bake_path(const char *path);
+int bake_write(const char *path, const ansr_view_t *view);
+bake_t * bake_map(const char *path, const char *src_path, const char *src_mask_path);
+bake_t * bake_unmap(bake_t *bake);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Collision masks are the opaque pixels of a sprite reduced to a coarser grid
+ * of cells, with any opaque pixel in a cell setting its bit.  Two masks
+ * placed on the same grid get tested for overlap a word at a time, with the
+ * second mask's rows shifted into the first's words on the fly.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bitmask.h"
+#include "macros.h"
+
+
+/* reduce the width x height 0xAABBGGRR pixels to a mask_width x mask_height mask */
+bitmask_t * bitmask_new(unsigned width, unsigned height, const uint32_t *pixels, unsigned mask_width, unsigned mask_height)
+{
+	unsigned	stride;
+	bitmask_t	*mask;
+
+	assert(pixels);
+	assert(mask_width && mask_height);
+
+	stride = (mask_width + 63) / 64;
+	mask = calloc(1, sizeof(bitmask_t) + stride * mask_height * sizeof(uint64_t));
+	fatal_if(!mask, "unable to allocate %ux%u bitmask", mask_width, mask_height);
+
+	mask->width = mask_width;
+	mask->height = mask_height;
+	mask->stride = stride;
+
+	for (unsigned y = 0; y < height; y++) {
+		const uint32_t	*row = &pixels[y * width];
+		uint64_t	*dest = &mask->rows[(size_t)y * mask_height / height * stride];
+
+		for (unsigned x = 0; x < width; x++) {
+			unsigned	cx = (size_t)x * mask_width / width;
+
+			if (row[x] & 0x80000000)
+				dest[cx / 64] |= 1ull << (cx & 63);
+		}
+	}
+
+	return mask;
+}
+
+
+bitmask_t * bitmask_free(bitmask_t *mask)
+{
+	free(mask);
+
+	return NULL;
+}
+
+
+/* the 64 cells of row starting at cell x, cells outside the row are clear */
+static inline uint64_t bitmask_row_bits(const bitmask_t *mask, const uint64_t *row, int x)
+{
+	int		w = x >> 6;	/* floor for negative x too */
+	unsigned	shift = x & 63;
+	uint64_t	lo = 0, hi = 0;
+
+	if (w >= 0 && w < (int)mask->stride)
+		lo = row[w] >> shift;
+
+	if (shift && w + 1 >= 0 && w + 1 < (int)mask->stride)
+		hi = row[w + 1] << (64 - shift);
+
+	return lo | hi;
+}
+
+
+/* do masks a and b share any set cells with their top-left corners at
+ * ax,ay and bx,by on the same grid?
+ */
+int bitmask_overlaps(const bitmask_t *a, int ax, int ay, const bitmask_t *b, int bx, int by)
+{
+	int	dx = bx - ax, dy = by - ay;	/* b's position relative to a */
+	int	y0, y1, x0, x1;
+
+	assert(a);
+	assert(b);
+
+	/* rows and columns of a covered by b */
+	y0 = MAX(dy, 0);
+	y1 = MIN(dy + (int)b->height, (int)a->height);
+	x0 = MAX(dx, 0);
+	x1 = MIN(dx + (int)b->width, (int)a->width);
+	if (y0 >= y1 || x0 >= x1)
+		return 0;
+
+	for (int y = y0; y < y1; y++) {
+		const uint64_t	*a_row = &a->rows[(size_t)y * a->stride];
+		const uint64_t	*b_row = &b->rows[(size_t)(y - dy) * b->stride];
+
+		for (int w = x0 >> 6; w <= (x1 - 1) >> 6; w++) {
+			if (a_row[w] & bitmask_row_bits(b, b_row, w * 64 - dx))
+				return 1;
+		}
+	}
+
+	return 0;
+}
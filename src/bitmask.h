@@ -0,0 +1,36 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BITMASK_H
+#define _BITMASK_H
+
+#include <stdint.h>
+
+/* 1 bit per cell collision masks for the pixel-precise narrowphase, kept free
+ * of GL so sars-bake can benchmark them.  Row y's bits live in
+ * rows[y * stride ...], cell x at bit (x & 63) of word x / 64.
+ */
+typedef struct bitmask_t {
+	unsigned	width, height;	/* in cells */
+	unsigned	stride;		/* words per row */
+	uint64_t	rows[];
+} bitmask_t;
+
+bitmask_t * bitmask_new(unsigned width, unsigned height, const uint32_t *pixels, unsigned mask_width, unsigned mask_height);
+bitmask_t * bitmask_free(bitmask_t *mask);
+int bitmask_overlaps(const bitmask_t *a, int ax, int ay, const bitmask_t *b, int bx, int by);
+
+#endif
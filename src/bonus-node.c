@@ -28,21 +28,18 @@
  * position and life-cycle of the node by returning STAGE_RENDER_FUNC_RET_FREE
  * when done.
  *
- * One particularly crufty aspect is the digit nodes are hung off a nested
- * stage within the bonus_node_t that's being explicitly rendered and freed,
- * rather than existing as direct descendants of the game stage.  This results
- * in some redundant stage_dirty()/stage_render()/stage_free() rigamarole here,
- * and is only being done because I want to vary the alpha in the render func
- * for fading the digits out as they decay - and the incoming stage_t on the
- * render func is a const so we can't set the alpha directly on the outer bonus
- * node before letting render naturally descend down to the children layers with
- * the adjusted alpha.
+ * The digits are drawn directly as tex instances rather than digit nodes, so
+ * the alpha for fading them out can simply be passed along when drawing them.
+ * Once released their float-up is entirely the instances' motion, set once at
+ * release, so the rest of the way only the elapsed time changes.
  *
- * It's no big deal for now, but it illustrates some of the unnecessary
- * friction remaining in the libstage API.  I'm not convinced constifying these
- * things is bringing enough value to justify these kinds of annoyances.  FIXME
+ * Every digit is its own tex, and a bonus is only a few digits, so these never
+ * reach tex.c's TEX_INSTANCES_MIN and always take tex_render_instances()' CPU
+ * path on purpose.  That still batches them w/whatever else shares their
+ * texels, like their atlas page, an instanced draw per digit would only add
+ * draw calls.
  *
- * Another crufty point is for now I threw the release decay duration in
+ * One crufty point is for now I threw the release decay duration in
  * bonus-node.h so that the caller can accesss it when storing at the release
  * pointer, while making it available here for compile-time evaluation of (1.f
  * / BONUS_NODE_RELEASE_MS).  Also the counter isn't really applied in
@@ -62,63 +59,85 @@
 #include "bonus-node.h"
 #include "digit-node.h"
 #include "m4f.h"
-#include "m4f-3dx.h"
+#include "tex.h"
 #include "v2f.h"
 
 typedef struct bonus_node_t {
-	stage_t		*stage;
+	m4f_t		*projection_x;
 	v2f_t		*position;
 	float		scale;
 	unsigned	release;
 	v2f_t		release_position;
+	unsigned	released:1;
 	unsigned	n_digits;
-	m4f_t		digits_x[];
+	struct {
+		tex_t		*tex;
+		tex_instance_t	instance;
+	}		digits[];
 } bonus_node_t;
 
+
+/* queues the digits on the CPU, see the comment at the top */
+static void bonus_node_draw(bonus_node_t *bonus_node, float alpha, float time)
+{
+	for (int i = 0; i < bonus_node->n_digits; i++)
+		tex_render_instances(bonus_node->digits[i].tex, alpha, bonus_node->projection_x, 0, time, 1, &bonus_node->digits[i].instance);
+}
+
+
 static stage_render_func_ret_t bonus_node_render(const stage_t *stage, void *object, float alpha, void *render_ctxt)
 {
 	bonus_node_t	*bonus_node = object;
-	v3f_t		scale;
 
 	assert(stage);
 	assert(bonus_node);
 
-	scale.x = scale.y = scale.z = bonus_node->scale;
-
 	if (bonus_node->release) {
-		float	t = 1.f - (1.f / BONUS_NODE_RELEASE_MS * (float)bonus_node->release);
+		float	time = (float)(BONUS_NODE_RELEASE_MS - bonus_node->release);
+
+		/* float up and away wobbling from the release position, fading out
+		 * as time goes from 0 to BONUS_NODE_RELEASE_MS.
+		 */
+		if (!bonus_node->released) {
+			for (int i = 0; i < bonus_node->n_digits; i++) {
+				bonus_node->digits[i].instance = (tex_instance_t){
+								.position = {
+									.x = bonus_node->release_position.x + bonus_node->scale*2.f + (float)i * -bonus_node->scale*2.f,
+									.y = bonus_node->release_position.y + bonus_node->scale*2.f,
+								},
+								.scale = { bonus_node->scale, bonus_node->scale },
+								.alpha = 1.f,
+								.fade = -1.f / BONUS_NODE_RELEASE_MS,
+								.velocity = { 0.f, .5f / BONUS_NODE_RELEASE_MS },
+								.sway = { .1f / BONUS_NODE_RELEASE_MS, 0.f },
+								.rate = -.1f,
+								.phase = (float)(BONUS_NODE_RELEASE_MS - 1) * .1f,
+							};
+			}
+			bonus_node->released = 1;
+		}
 
 		bonus_node->release--;
 		if (!bonus_node->release)
 			return STAGE_RENDER_FUNC_RET_FREE;
 
-		for (int i = 0; i < bonus_node->n_digits; i++) {
-			bonus_node->digits_x[i] = m4f_translate(NULL, &(v3f_t){
-								.x = bonus_node->release_position.x + bonus_node->scale*2.f + (float)i * -bonus_node->scale*2.f + (t * sinf((float)bonus_node->release * .1f) * .1f),
-								.y = bonus_node->release_position.y + bonus_node->scale*2.f + t * .5f,
-								.z = 0.f
-							});
-			bonus_node->digits_x[i] = m4f_scale(&bonus_node->digits_x[i], &scale);
-		}
-
-		stage_set_alpha(bonus_node->stage, 1.f - t);
-		stage_dirty(bonus_node->stage);
-		stage_render(bonus_node->stage, render_ctxt);
+		bonus_node_draw(bonus_node, alpha, time);
 
 		return STAGE_RENDER_FUNC_RET_CONTINUE;
 	}
 
-	/* update tranforms for the digits before they render */
+	/* follow the entity until released */
 	for (int i = 0; i < bonus_node->n_digits; i++) {
-		bonus_node->digits_x[i] = m4f_translate(NULL, &(v3f_t){
+		bonus_node->digits[i].instance = (tex_instance_t){
+							.position = {
 								.x = bonus_node->position->x + bonus_node->scale * 2.f + (float)i * -bonus_node->scale * 2.f,
 								.y = bonus_node->position->y + bonus_node->scale*2.f,
-								.z = 0.f
-							});
-		bonus_node->digits_x[i] = m4f_scale(&bonus_node->digits_x[i], &scale);
+							},
+							.scale = { bonus_node->scale, bonus_node->scale },
+							.alpha = 1.f,
+						};
 	}
-	stage_dirty(bonus_node->stage);
-	stage_render(bonus_node->stage, render_ctxt);
+	bonus_node_draw(bonus_node, alpha, 0.f);
 
 	return STAGE_RENDER_FUNC_RET_CONTINUE;
 }
@@ -129,7 +148,9 @@ static void bonus_node_free(const stage_t *stage, void *object)
 	bonus_node_t	*bonus_node = object;
 
 	assert(stage);
-	stage_free(bonus_node->stage);
+
+	for (int i = 0; i < bonus_node->n_digits; i++)
+		tex_free(bonus_node->digits[i].tex);
 	free(bonus_node);
 }
 
@@ -156,12 +177,12 @@ stage_t * bonus_node_new(stage_conf_t *conf, unsigned value, m4f_t *projection_x
 		v /= 10;
 	} while (v);
 
-	bonus_node = calloc(1, sizeof(bonus_node_t) + n_digits * sizeof(bonus_node->digits_x[0]));
+	bonus_node = calloc(1, sizeof(bonus_node_t) + n_digits * sizeof(bonus_node->digits[0]));
 	assert(bonus_node);
 	bonus_node->n_digits = n_digits;
+	bonus_node->projection_x = projection_x;
 	bonus_node->position = position;
 	bonus_node->scale = scale;
-	bonus_node->stage = stage_new(&(stage_conf_t){.name = "bonus-container", .active = 1, .alpha = 1.f}, NULL, NULL); /* use a discrete container stage for render_func alpha control */
 	*release = &bonus_node->release;
 	*release_position = &bonus_node->release_position;
 
@@ -170,9 +191,7 @@ stage_t * bonus_node_new(stage_conf_t *conf, unsigned value, m4f_t *projection_x
 
 	v = value;
 	do {
-		/* TODO: model_x positioning of the digits */
-		(void) digit_node_new(&(stage_conf_t){ .parent = bonus_node->stage, .name = "bonus-digit", .active = 1, .alpha = 1.f },
-			v % 10, projection_x, &bonus_node->digits_x[i++]);
+		bonus_node->digits[i++].tex = digit_tex_new(v % 10);
 		v /= 10;
 	} while (v);
 
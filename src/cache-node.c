@@ -0,0 +1,197 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Caches the rendering of a subtree which rarely changes in a texture,
+ * compositing that as a single quad every frame instead of rendering the
+ * subtree.  The subtree hangs off of a separate contents stage, and gets
+ * rendered into the texture again only when whoever changes it bumps the
+ * version, or the viewport got resized, or textures got reuploaded.
+ *
+ * The texture only covers the extents of what the contents drew the last time
+ * they got rendered, see tex_track_extents(), so a few digits don't cost a
+ * viewport sized texture and quad.  When the contents outgrow those they just
+ * get rendered again into a texture covering the new extents.
+ *
+ * Contents changing frame after frame gain nothing from the texture, so once
+ * the version changed on consecutive frames they get rendered directly until
+ * it holds still again.
+ *
+ * The contents are rendered w/their own alpha, the cache node's alpha gets
+ * applied when compositing, see tex-target.c.
+ */
+
+#include <assert.h>
+#include <float.h>
+#include <stdlib.h>
+
+#include <stage.h>
+
+#include "bb2f.h"
+#include "cache-node.h"
+#include "macros.h"
+#include "tex.h"
+#include "tex-target.h"
+
+typedef struct cache_node_t {
+	stage_t		*contents;
+	const unsigned	*version;
+	unsigned	rendered_version, seen_version, reuploads;
+	unsigned	changing:1;	/* version changed last frame */
+	bb2f_t		extents;	/* of the contents when last rendered into target */
+	tex_target_t	*target;
+} cache_node_t;
+
+static unsigned	cache_hits, cache_misses, cache_bypasses;
+
+
+/* render the contents into target, and again if they outgrew its extents */
+static void cache_node_fill(cache_node_t *cache, void *render_ctxt)
+{
+	for (int pass = 0;; pass++) {
+		bb2f_t	*tracked;
+
+		cache->extents = (bb2f_t){ .min = { FLT_MAX, FLT_MAX }, .max = { -FLT_MAX, -FLT_MAX } };
+
+		tex_target_begin(cache->target);
+		tracked = tex_track_extents(&cache->extents);
+		stage_dirty(cache->contents);
+		(void) stage_render(cache->contents, render_ctxt);
+		(void) tex_track_extents(tracked);
+		tex_target_end(cache->target);
+
+		/* refitting to the extents just found always covers them, but don't bet a loop on floats */
+		if (pass || tex_target_covers(cache->target, &cache->extents))
+			break;
+
+		(void) tex_target_fit_bounds(cache->target, 1.f, &cache->extents);
+	}
+}
+
+
+static stage_render_func_ret_t cache_node_render(const stage_t *stage, void *object, float alpha, void *render_ctxt)
+{
+	cache_node_t	*cache = object;
+	int		changed, stale;
+
+	assert(stage);
+	assert(cache);
+
+	changed = (*(cache->version) != cache->seen_version);
+	cache->seen_version = *(cache->version);
+
+	if (changed && cache->changing) {
+		/* rendered_version is left stale, for rendering into target once this settles */
+		stage_set_alpha(cache->contents, alpha);
+		stage_dirty(cache->contents);
+		(void) stage_render(cache->contents, render_ctxt);
+		stage_set_alpha(cache->contents, 1.f);
+		cache_bypasses++;
+
+		return STAGE_RENDER_FUNC_RET_CONTINUE;
+	}
+	cache->changing = changed;
+
+	stale = (*(cache->version) != cache->rendered_version || tex_reuploads() != cache->reuploads);
+	if (tex_target_fit_bounds(cache->target, 1.f, &cache->extents))
+		stale = 1;
+
+	if (stale) {
+		cache_node_fill(cache, render_ctxt);
+
+		cache->rendered_version = *(cache->version);
+		cache->reuploads = tex_reuploads();
+		cache_misses++;
+	} else {
+		cache_hits++;
+	}
+
+	/* the contents didn't draw anything */
+	if (cache->extents.min.x > cache->extents.max.x)
+		return STAGE_RENDER_FUNC_RET_CONTINUE;
+
+	tex_target_render(cache->target, alpha);
+
+	return STAGE_RENDER_FUNC_RET_CONTINUE;
+}
+
+
+static void cache_node_free(const stage_t *stage, void *object)
+{
+	cache_node_t	*cache = object;
+
+	assert(stage);
+	assert(cache);
+
+	stage_free(cache->contents);
+	tex_target_free(cache->target);
+	free(cache);
+}
+
+
+static const stage_ops_t cache_node_ops = {
+	.render_func = cache_node_render,
+	.free_func = cache_node_free,
+};
+
+
+/* return a node compositing a cached rendering of the stage stored at
+ * res_contents, for hanging the cached subtree off of.  Whenever anything in
+ * there changes *version must change too, which must remain valid for the
+ * lifetime of the node.
+ */
+stage_t * cache_node_new(stage_conf_t *conf, const unsigned *version, stage_t **res_contents)
+{
+	cache_node_t	*cache;
+	stage_t		*s;
+
+	assert(conf);
+	assert(version);
+	assert(res_contents);
+
+	cache = calloc(1, sizeof(cache_node_t));
+	fatal_if(!cache, "Unable to allocate cache_node \"%s\"", conf->name);
+
+	s = stage_new(conf, &cache_node_ops, cache);
+	fatal_if(!s, "Unable to create stage \"%s\"", conf->name);
+
+	/* a discrete root stage so the contents only get rendered by us, into tex */
+	cache->contents = stage_new(&(stage_conf_t){ .name = "cache-contents", .active = 1, .alpha = 1.f }, NULL, NULL);
+	fatal_if(!cache->contents, "Unable to create contents stage for \"%s\"", conf->name);
+	cache->version = version;
+	cache->seen_version = *version;
+	cache->extents = (bb2f_t){ .min = { FLT_MAX, FLT_MAX }, .max = { -FLT_MAX, -FLT_MAX } };
+	cache->target = tex_target_new();
+	*res_contents = cache->contents;
+
+	return s;
+}
+
+
+/* the number of times cache nodes composited their cached rendering as-is, had
+ * to render their contents again, and rendered their changing contents
+ * directly, so far
+ */
+void cache_node_stats(unsigned *res_hits, unsigned *res_misses, unsigned *res_bypasses)
+{
+	if (res_hits)
+		*res_hits = cache_hits;
+
+	if (res_misses)
+		*res_misses = cache_misses;
+
+	if (res_bypasses)
+		*res_bypasses = cache_bypasses;
+}
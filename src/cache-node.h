@@ -0,0 +1,26 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CACHE_NODE_H
+#define _CACHE_NODE_H
+
+typedef struct stage_t stage_t;
+typedef struct stage_conf_t stage_conf_t;
+
+stage_t * cache_node_new(stage_conf_t *conf, const unsigned *version, stage_t **res_contents);
+void cache_node_stats(unsigned *res_hits, unsigned *res_misses, unsigned *res_bypasses);
+
+#endif
@@ -21,10 +21,12 @@
 #include "clear-node.h"
 #include "glad.h"
 #include "macros.h"
+#include "tex.h"
 
 
 static stage_render_func_ret_t clear_node_render(const stage_t *stage, void *object, float alpha, void *render_ctxt)
 {
+	tex_flush();
 	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
 	return STAGE_RENDER_FUNC_RET_CONTINUE;
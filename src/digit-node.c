@@ -47,17 +47,26 @@ static const char	*digits_masks_assets[10] = {
 	"assets/nine.mask.ans",
 };
 
-static tex_t		*digits_tex[10];
-
 #define DIGIT_WIDTH	184
 #define DIGIT_HEIGHT	288
 
-stage_t * digit_node_new(stage_conf_t *conf, unsigned digit, m4f_t *projection_x, m4f_t *model_x)
+/* return a new reference to digit's texture, for drawing it without a node */
+tex_t * digit_tex_new(unsigned digit)
 {
 	assert(digit < 10);
 
-	if (!digits_tex[digit])
-		digits_tex[digit] = ansr_tex_new(digits_assets[digit], digits_masks_assets[digit]);
+	return ansr_tex_new(digits_assets[digit], digits_masks_assets[digit]);
+}
+
+
+stage_t * digit_node_new(stage_conf_t *conf, unsigned digit, m4f_t *projection_x, m4f_t *model_x)
+{
+	tex_t	*tex;
+	stage_t	*s;
+
+	tex = digit_tex_new(digit);
+	s = tex_node_new_tex(conf, tex, projection_x, model_x);
+	tex_free(tex);
 
-	return tex_node_new_tex(conf, digits_tex[digit], projection_x, model_x);
+	return s;
 }
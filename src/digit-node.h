@@ -19,7 +19,9 @@
 
 typedef struct stage_conf_t stage_conf_t;
 typedef struct m4f_t m4f_t;
+typedef struct tex_t tex_t;
 
+tex_t * digit_tex_new(unsigned digit);
 stage_t * digit_node_new(stage_conf_t *conf, unsigned digit, m4f_t *projection_x, m4f_t *model_x);
 
 #endif
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Embedded assets are the sprites compiled into the executable by way of
+ * the embed-assets.c sars-bake generates at build time.
+ *
+ * Fully rasterized RGBA would cost ~14MiB of .rodata for what's really a
+ * 16 color palette + transparency, so they're stored as run-length encoded
+ * ansr_view_palette[] indices instead.  Each run is a pair of bytes:
+ * (length - 1, index), with EMBED_TRANSPARENT for the index of transparent
+ * pixels.  Expanding that back out to RGBA is just a table lookup per pixel
+ * and involves no filesystem access at all.
+ *
+ * Their ansr_cells_t grids for --cell-textures are embedded as-is, at 4 bytes
+ * per 8x16 cell they're small enough not to bother compressing.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ansr-view.h"
+#include "embed.h"
+#include "macros.h"
+
+
+/* returns the embedded asset for the path and mask_path pair, NULL if there isn't one */
+const embed_asset_t * embed_asset_lookup(const char *path, const char *mask_path)
+{
+	assert(path);
+
+	for (unsigned i = 0; i < embed_n_assets; i++) {
+		if (STREQ(embed_assets[i].path, path) &&
+		    STREQ(embed_assets[i].mask_path, mask_path))
+			return &embed_assets[i];
+	}
+
+	return NULL;
+}
+
+
+/* decode an embedded asset into a newly allocated ansr_view_t */
+ansr_view_t * embed_asset_view(const embed_asset_t *asset)
+{
+	uint32_t	palette[EMBED_TRANSPARENT + 1];
+	size_t		n_pixels, pos = 0;
+	ansr_view_t	*v;
+
+	assert(asset);
+
+	memcpy(palette, ansr_view_palette, sizeof(ansr_view_palette));
+	palette[EMBED_TRANSPARENT] = 0;
+
+	n_pixels = asset->width * asset->height;
+	v = malloc(sizeof(ansr_view_t) + n_pixels * sizeof(uint32_t));
+	if (!v)
+		return NULL;
+
+	v->width = asset->width;
+	v->height = asset->height;
+
+	for (size_t i = 0; i + 1 < asset->rle_len; i += 2) {
+		unsigned	len = asset->rle[i] + 1;
+		uint32_t	pixel;
+
+		fatal_if(asset->rle[i + 1] > EMBED_TRANSPARENT || pos + len > n_pixels,
+			"corrupt embedded asset \"%s\"", asset->path);
+
+		pixel = palette[asset->rle[i + 1]];
+		for (unsigned j = 0; j < len; j++)
+			v->pixels[pos++] = pixel;
+	}
+
+	fatal_if(pos != n_pixels, "truncated embedded asset \"%s\"", asset->path);
+
+	return v;
+}
+
+
+/* copy an embedded asset's cells into a newly allocated ansr_cells_t */
+ansr_cells_t * embed_asset_cells(const embed_asset_t *asset)
+{
+	size_t		size;
+	ansr_cells_t	*c;
+
+	assert(asset);
+
+	size = asset->cells_width * asset->cells_height * sizeof(uint32_t);
+	c = malloc(sizeof(ansr_cells_t) + size);
+	if (!c)
+		return NULL;
+
+	c->width = asset->cells_width;
+	c->height = asset->cells_height;
+	memcpy(c->cells, asset->cells, size);
+
+	return c;
+}
@@ -0,0 +1,46 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _EMBED_H
+#define _EMBED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ansr_view_palette[] index used for fully transparent pixels */
+#define EMBED_TRANSPARENT	16
+
+typedef struct ansr_cells_t ansr_cells_t;
+typedef struct ansr_view_t ansr_view_t;
+
+typedef struct embed_asset_t {
+	const char		*path, *mask_path;
+	unsigned		width, height;
+	const unsigned char	*rle;
+	size_t			rle_len;
+	unsigned		cells_width, cells_height;
+	const uint32_t		*cells;
+} embed_asset_t;
+
+/* these are defined in the embed-assets.c generated by sars-bake --embed */
+extern const embed_asset_t	embed_assets[];
+extern const unsigned		embed_n_assets;
+
+const embed_asset_t * embed_asset_lookup(const char *path, const char *mask_path);
+ansr_view_t * embed_asset_view(const embed_asset_t *asset);
+ansr_cells_t * embed_asset_cells(const embed_asset_t *asset);
+
+#endif
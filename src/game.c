@@ -16,6 +16,8 @@
 
 #include <SDL.h>
 #include <assert.h>
+#include <math.h>
+#include <string.h>
 
 #include <ix2.h>
 #include <pad.h>
@@ -25,13 +27,18 @@
 #include "adult-node.h"
 #include "adult-maga-node.h"
 #include "adult-masked-node.h"
+#include "ansr-tex.h"
+#include "ansr-view.h"
 #include "baby-hatted-node.h"
 #include "baby-node.h"
 #include "bb2f.h"
 #include "bb3f.h"
+#include "bitmask.h"
 #include "bonus-node.h"
+#include "cache-node.h"
 #include "digit-node.h"
 #include "glad.h"
+#include "loader.h"
 #include "m4f.h"
 #include "m4f-3dx.h"
 #include "m4f-bbx.h"
@@ -42,6 +49,8 @@
 #include "sars.h"
 #include "sfx.h"
 #include "teepee-node.h"
+#include "tex.h"
+#include "tex-atlas.h"
 #include "tv-node.h"
 #include "v2f.h"
 #include "virus-node.h"
@@ -70,6 +79,7 @@
 #define GAME_TV_ATTRACTION	.005f
 
 #define GAME_TP_WIN_THRESHOLD	256
+#define GAME_TP_MAX_QUANTITY	128	/* the most teepee a single pickup can hold, w/--cheat */
 
 #define GAME_KBD_DELAY_MS	20
 #define GAME_KBD_TIMER		PLAY_TICKS_TIMER4
@@ -91,16 +101,56 @@
 #define GAME_VIRUS_SCALE	(v3f_t){ .05f, .05f, .05f }
 #define GAME_DIGITS_SCALE	(v3f_t){ .05f, .05f, .05f }
 
+#define GAME_COLLISION_RES	256.f	/* collision mask cells per unit of projection space */
+
 #define GAME_TV_CHANCE		.05f
 #define GAME_MAGA_CHANCE	.75f	/* XXX: MAGA only attempted when captivated by tv */
 #define GAME_MASK_CHANCE	.02f
 #define GAME_TEEPEE_CHANCE	.55f
 
 
-/* every entity just starts with a unit cube AABB and is transformed with a matrix into its position,
- * so here's a convenient aabb to feed into those transformations as needed.
+/* Every sprite the game context can ever need, these get loaded in the
+ * background from game_init() while the hungrycat splash is up.  Even the
+ * ones which only appear on some event, so their first occurrence doesn't
+ * hitch the game.  Anything loaded while playing which isn't listed here
+ * gets warned about in game_update().
+ */
+static const struct {
+	const char	*path, *mask_path;
+	float		scale;	/* largest GAME_*_SCALE component it gets drawn at, for the lod */
+} game_sprites[] = {
+	/* reset_game() */
+	{ "assets/adult.ans", "assets/adult.mask.ans", .07f },
+	{ "assets/baby.ans", "assets/baby.mask.ans", .05f },
+	{ "assets/maga.ans", "assets/maga.mask.ans", .05f },
+	{ "assets/mask.ans", "assets/mask.mask.ans", .04299f },
+	{ "assets/teepee.ans", "assets/teepee.mask.ans", .07f },
+	{ "assets/tv.ans", "assets/tv.mask.ans", .2f },
+	{ "assets/virus.ans", "assets/virus.mask.ans", .05f },
+
+	/* first MAGA/mask pickup, first hatted baby */
+	{ "assets/adult-maga.ans", "assets/adult-maga.mask.ans", .07f },
+	{ "assets/adult-masked.ans", "assets/adult-masked.mask.ans", .07f },
+	{ "assets/baby-hatted.ans", "assets/baby-hatted.mask.ans", .05f },
+
+	/* show_score() */
+	{ "assets/zero.ans", "assets/zero.mask.ans", .05f },
+	{ "assets/one.ans", "assets/one.mask.ans", .05f },
+	{ "assets/two.ans", "assets/two.mask.ans", .05f },
+	{ "assets/three.ans", "assets/three.mask.ans", .05f },
+	{ "assets/four.ans", "assets/four.mask.ans", .05f },
+	{ "assets/five.ans", "assets/five.mask.ans", .05f },
+	{ "assets/six.ans", "assets/six.mask.ans", .05f },
+	{ "assets/seven.ans", "assets/seven.mask.ans", .05f },
+	{ "assets/eight.ans", "assets/eight.mask.ans", .05f },
+	{ "assets/nine.ans", "assets/nine.mask.ans", .05f },
+};
+
+/* every entity just starts with a unit cube and is transformed with a matrix into its position,
+ * its AABB is the opaque part of its sprite within that cube, see entity_set_shape().
+ * AABB overlaps found in the ix2 are only hits when the entities' collision masks overlap
+ * as well, see entity_collides().
  */
-static const bb3f_t	any_aabb = { .min = { -1.f, -1.f, -1.f }, .max = { 1.f, 1.f, 1.f } };
 
 typedef enum game_state_t {
 	GAME_STATE_PLAYING,
@@ -120,7 +170,6 @@ typedef enum entity_type_t {
 	ENTITY_TYPE_MAGA,
 	ENTITY_TYPE_MASK,
 	ENTITY_TYPE_TEEPEE,
-	ENTITY_TYPE_TEEPEE_ICON,
 } entity_type_t;
 
 typedef union entity_t entity_t;
@@ -133,7 +182,10 @@ struct entity_any_t {
 	v2f_t		position;
 	v3f_t		scale;
 	m4f_t		model_x;
+	bb3f_t		aabb;
 	bb2f_t		aabb_x;
+	const bitmask_t	*bitmask;	/* shared by every entity w/the same sprite and scale */
+	int		bitmask_x, bitmask_y;	/* top-left corner of the bitmask in GAME_COLLISION_RES cells */
 	unsigned	flashing:1;
 	entity_any_t	*flashers_next;
 	unsigned	flashes_remaining;
@@ -174,11 +226,6 @@ typedef struct teepee_t {
 	v2f_t		*bonus_release_position;
 } teepee_t;
 
-typedef struct teepee_icon_t {
-	entity_any_t		entity;
-	struct teepee_icon_t	*next;
-} teepee_icon_t;
-
 typedef struct tv_t {
 	entity_any_t	entity;
 } tv_t;
@@ -194,6 +241,14 @@ union entity_t {
 	virus_t		virus;
 };
 
+typedef struct game_bitmask_t game_bitmask_t;
+struct game_bitmask_t {
+	game_bitmask_t	*next;
+	const char	*path;
+	v3f_t		scale;
+	bitmask_t	*bitmask;
+};
+
 typedef struct game_t {
 	game_state_t	state;
 
@@ -211,13 +266,16 @@ typedef struct game_t {
 	stage_t		*babies_node;
 	stage_t		*viruses_node;
 	stage_t		*plasma_node;
-	stage_t		*score_node;
+	stage_t		*score_node, *score_digits_node;
+	unsigned	score_version;	/* of score_digits_node's contents, see cache_node_new() */
 	ix2_t		*ix2;
 	pad_t		*pad;
 
-	/* count of hoarded teepee and list of representative icons for animating @ win */
+	/* count of hoarded teepee and their representative icons for animating @ win */
 	unsigned	teepee_cnt;
-	teepee_icon_t	*teepee_head;
+	tex_instance_t	teepee_icons[GAME_TP_WIN_THRESHOLD - 1 + GAME_TP_MAX_QUANTITY];
+	float		teepee_time;	/* of the icons' motion, see tex_instance_t */
+	unsigned	teepee_version;	/* of the icons' rendering, see cache_node_new() */
 	entity_any_t	*flashers_on_head, *flashers_off_head;
 	baby_t		*rescues_head;
 	unsigned	babies_cnt;
@@ -232,6 +290,8 @@ typedef struct game_t {
 	float		infections_rate, infections_rate_smoothed; /* 0-1 for none-max */
 	virus_t		*viruses[GAME_NUM_VIRUSES];
 	m4f_t		score_digits_x[10];
+	unsigned	packed:1;
+	game_bitmask_t	*bitmasks;
 } game_t;
 
 
@@ -241,22 +301,83 @@ static inline float randf(void)
 }
 
 
+/* get the collision mask for path + mask_path drawn at scale, building it on first use */
+static const bitmask_t * game_bitmask(game_t *game, const char *path, const char *mask_path, const v3f_t *scale)
+{
+	game_bitmask_t	*b;
+	ansr_view_t	*v;
+
+	for (b = game->bitmasks; b; b = b->next) {
+		if (!strcmp(b->path, path) && b->scale.x == scale->x && b->scale.y == scale->y)
+			return b->bitmask;
+	}
+
+	b = calloc(1, sizeof(game_bitmask_t));
+	fatal_if(!b, "unable to allocate game_bitmask_t");
+
+	v = ansr_tex_decode(path, mask_path);
+	fatal_if(!v, "unable to decode \"%s\" for its collision mask", path);
+
+	b->path = path;
+	b->scale = *scale;
+	b->bitmask = bitmask_new(v->width, v->height, v->pixels,
+				 MAX(lrintf(scale->x * 2.f * GAME_COLLISION_RES), 1),
+				 MAX(lrintf(scale->y * 2.f * GAME_COLLISION_RES), 1));
+	ansr_view_free(v);
+
+	b->next = game->bitmasks;
+	game->bitmasks = b;
+
+	return b->bitmask;
+}
+
+
+/* set the entity's untransformed AABB to the opaque bounds of its sprite, so collisions
+ * don't happen in the transparent margins, and its collision mask for the same sprite at
+ * the entity's scale.  Called again with the variant's sprite whenever the entity's node
+ * gets replaced, followed by entity_update_x() to refresh the transformed shape.
+ */
+static void entity_set_shape(game_t *game, entity_any_t *entity, const char *path, const char *mask_path)
+{
+	bb2f_t	bounds;
+	tex_t	*tex;
+
+	tex = ansr_tex_new(path, mask_path);
+	tex_opaque(tex, &bounds);
+	tex_free(tex);
+
+	entity->aabb = (bb3f_t){
+				.min = { bounds.min.x, bounds.min.y, -1.f },
+				.max = { bounds.max.x, bounds.max.y, 1.f },
+			};
+
+	entity->bitmask = game_bitmask(game, path, mask_path, &entity->scale);
+}
+
+
+/* narrowphase for AABB overlaps from the ix2, do the entities' collision masks overlap? */
+static int entity_collides(const entity_any_t *a, const entity_any_t *b)
+{
+	if (!a->bitmask || !b->bitmask)
+		return 1;
+
+	return bitmask_overlaps(a->bitmask, a->bitmask_x, a->bitmask_y, b->bitmask, b->bitmask_x, b->bitmask_y);
+}
+
+
 /* update the entity's transformation and position in the index */
 static void entity_update_x(game_t *game, entity_any_t *entity)
 {
-	/* icon entities aren't intended to get indexed spatially, so we don't really initialize them
-	 * fully for that purpose.  Right now it's just the teepee icon, but assert it never manages to
-	 * get passed here.  TODO: it probably makes sense to break icon tentities out to a separate
-	 * non-entity type that doesn't even have ix2 related members.
-	 */
-	assert(entity->type != ENTITY_TYPE_TEEPEE_ICON);
-
 	entity->model_x = m4f_translate(NULL, &(v3f_t){ entity->position.x, entity->position.y, 0.f });
 	entity->model_x = m4f_scale(&entity->model_x, &entity->scale);
 
-	/* apply the entities transform to any_aabb to get the current transformed aabb, cache it in the
+	/* apply the entities transform to its aabb to get the current transformed aabb, cache it in the
 	 * entity in case a search needs to be done... */
-	m4f_mult_bb3f_bb2f(&entity->model_x, &any_aabb, &entity->aabb_x);
+	m4f_mult_bb3f_bb2f(&entity->model_x, &entity->aabb, &entity->aabb_x);
+
+	/* the bitmask covers the whole unit cube, its first row at the top (+y) */
+	entity->bitmask_x = lrintf((entity->position.x - entity->scale.x) * GAME_COLLISION_RES);
+	entity->bitmask_y = lrintf(-(entity->position.y + entity->scale.y) * GAME_COLLISION_RES);
 
 	if (!(entity->ix2_object)) {
 		entity->ix2_object = ix2_object_new(game->ix2, NULL, NULL, &entity->aabb_x, entity);
@@ -282,6 +403,7 @@ static adult_t * adult_new(game_t *game, stage_t *parent)
 	adult->entity.type = ENTITY_TYPE_ADULT;
 	adult->entity.node = adult_node_new(&(stage_conf_t){ .parent = parent, .name = "adult", .layer = 3, .alpha = 1.f }, &game->sars->projection_x, &adult->entity.model_x);
 	adult->entity.scale = GAME_ADULT_SCALE;
+	entity_set_shape(game, &adult->entity, "assets/adult.ans", "assets/adult.mask.ans");
 	entity_update_x(game, &adult->entity);
 
 	return adult;
@@ -298,6 +420,7 @@ static baby_t * baby_new(game_t *game, stage_t *parent, baby_t *rescue)
 		baby->entity.type = ENTITY_TYPE_BABY;
 		baby->entity.node = baby_node_new(&(stage_conf_t){ .parent = parent, .name = "baby", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &baby->entity.model_x);
 		baby->entity.scale = GAME_BABY_SCALE;
+		entity_set_shape(game, &baby->entity, "assets/baby.ans", "assets/baby.mask.ans");
 	} else
 		stage_set_active(baby->entity.node, 1);
 
@@ -319,6 +442,7 @@ static maga_t * maga_new(game_t *game, stage_t *parent)
 	maga->entity.type = ENTITY_TYPE_MAGA;
 	maga->entity.node = maga_node_new(&(stage_conf_t){ .parent = parent, .name = "maga", .layer = 6, .alpha = 1.f }, &game->sars->projection_x, &maga->entity.model_x);
 	maga->entity.scale = GAME_MAGA_SCALE;
+	entity_set_shape(game, &maga->entity, "assets/maga.ans", "assets/maga.mask.ans");
 
 	return maga;
 }
@@ -334,6 +458,7 @@ static mask_t * mask_new(game_t *game, stage_t *parent)
 	mask->entity.type = ENTITY_TYPE_MASK;
 	mask->entity.node = mask_node_new(&(stage_conf_t){ .parent = parent, .name = "mask", .layer = 6, .alpha = 1.f }, &game->sars->projection_x, &mask->entity.model_x);
 	mask->entity.scale = GAME_MASK_SCALE;
+	entity_set_shape(game, &mask->entity, "assets/mask.ans", "assets/mask.mask.ans");
 
 	return mask;
 }
@@ -349,6 +474,7 @@ static teepee_t * teepee_new(game_t *game, stage_t *parent)
 	teepee->entity.type = ENTITY_TYPE_TEEPEE;
 	teepee->entity.node = teepee_node_new(&(stage_conf_t){ .parent = parent, .name = "teepee", .layer = 4, .alpha = 1.f }, &game->sars->projection_x, &teepee->entity.model_x);
 	teepee->entity.scale = GAME_TEEPEE_SCALE;
+	entity_set_shape(game, &teepee->entity, "assets/teepee.ans", "assets/teepee.mask.ans");
 
 	return teepee;
 }
@@ -364,6 +490,7 @@ static tv_t * tv_new(game_t *game, stage_t *parent)
 	tv->entity.type = ENTITY_TYPE_TV;
 	tv->entity.node = tv_node_new(&(stage_conf_t){ .parent = parent, .name = "tv", .layer = 1, .alpha = 1.f }, &game->sars->projection_x, &tv->entity.model_x);
 	tv->entity.scale = GAME_TV_SCALE;
+	entity_set_shape(game, &tv->entity, "assets/tv.ans", "assets/tv.mask.ans");
 	entity_update_x(game, &tv->entity);
 
 	return tv;
@@ -387,6 +514,7 @@ static virus_t * virus_new(game_t *game, stage_t *parent)
 	virus->entity.type = ENTITY_TYPE_VIRUS;
 	virus->entity.node = virus_node_new(&(stage_conf_t){ .parent = parent, .name = "virus", .alpha = 1.f }, &game->sars->projection_x, &virus->entity.model_x);
 	virus->entity.scale = GAME_VIRUS_SCALE;
+	entity_set_shape(game, &virus->entity, "assets/virus.ans", "assets/virus.mask.ans");
 	randomize_virus(virus);
 	entity_update_x(game, &virus->entity);
 
@@ -436,6 +564,8 @@ static void infect_entity(game_t *game, entity_t *entity, const char *name)
 {
 	/* convert entity into inanimate virus (off the viruses array) */
 	(void) virus_node_new(&(stage_conf_t){ .stage = entity->any.node, .replace = 1, .name = name, .active = 1, .alpha = 1.f }, &game->sars->projection_x, &entity->any.model_x);
+	entity_set_shape(game, &entity->any, "assets/virus.ans", "assets/virus.mask.ans");
+	entity_update_x(game, &entity->any);
 	sfx_play(&sfx.baby_infected, entity_volume(game, &entity->any));
 	entity->any.type = ENTITY_TYPE_VIRUS;
 	entity->virus.corpse = 1;
@@ -449,6 +579,8 @@ static void infect_entity(game_t *game, entity_t *entity, const char *name)
 static void hat_baby(game_t *game, baby_t *baby, mask_t *mask)
 {
 	(void) baby_hatted_node_new(&(stage_conf_t){ .stage = baby->entity.node, .replace = 1, .name = "baby-hatted", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &baby->entity.model_x);
+	entity_set_shape(game, &baby->entity, "assets/baby-hatted.ans", "assets/baby-hatted.mask.ans");
+	entity_update_x(game, &baby->entity);
 	sfx_play(&sfx.baby_hatted, entity_volume(game, &baby->entity));
 
 	stage_set_active(mask->entity.node, 0);
@@ -458,6 +590,8 @@ static void hat_baby(game_t *game, baby_t *baby, mask_t *mask)
 static void maga_adult(game_t *game, adult_t *adult, maga_t *maga)
 {
 	(void) adult_maga_node_new(&(stage_conf_t){ .stage = adult->entity.node, .replace = 1, .name = "adult-maga", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &adult->entity.model_x);
+	entity_set_shape(game, &adult->entity, "assets/adult-maga.ans", "assets/adult-maga.mask.ans");
+	entity_update_x(game, &adult->entity);
 
 	adult->masked = 0;
 	/* XXX: this is kind of kludge-y: originally the maga flag was part of adult_t where it arguably belongs, but
@@ -483,6 +617,8 @@ static void mask_adult(game_t *game, adult_t *adult, mask_t *mask)
 	}
 
 	(void) adult_masked_node_new(&(stage_conf_t){ .stage = adult->entity.node, .replace = 1, .name = "adult-masked", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &adult->entity.model_x);
+	entity_set_shape(game, &adult->entity, "assets/adult-masked.ans", "assets/adult-masked.mask.ans");
+	entity_update_x(game, &adult->entity);
 
 	adult->masked += GAME_MASK_PROTECTION;
 	sfx_play(&sfx.adult_mine, 1.f);
@@ -496,6 +632,8 @@ static int expose_adult(game_t *game, adult_t *adult, virus_t *virus)
 	if (adult->masked) {
 		if (!--adult->masked) {
 			(void) adult_node_new(&(stage_conf_t){ .stage = adult->entity.node, .replace = 1, .name = "adult-unmasked", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &adult->entity.model_x);
+			entity_set_shape(game, &adult->entity, "assets/adult.ans", "assets/adult.mask.ans");
+			entity_update_x(game, &adult->entity);
 			sfx_play(&sfx.adult_unmasked, 1.f);
 		} else
 			sfx_play(&sfx.adult_maskhit, 1.f);
@@ -507,10 +645,14 @@ static int expose_adult(game_t *game, adult_t *adult, virus_t *virus)
 
 	/* convert adult into inanimate virus (off the viruses array) */
 	(void) virus_node_new(&(stage_conf_t){ .stage = adult->entity.node, .replace = 1, .name = "adult-virus", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &adult->entity.model_x);
+	entity_set_shape(game, &adult->entity, "assets/virus.ans", "assets/virus.mask.ans");
+	entity_update_x(game, &adult->entity);
 	sfx_play(&sfx.adult_infected, 1.f);
 
 	if (adult->holding) {
 		(void) virus_node_new(&(stage_conf_t){ .stage = adult->holding->entity.node, .replace = 1, .name = "baby-virus", .active = 1, .alpha = 1.f }, &game->sars->projection_x, &adult->holding->entity.model_x);
+		entity_set_shape(game, &adult->holding->entity, "assets/virus.ans", "assets/virus.mask.ans");
+		entity_update_x(game, &adult->holding->entity);
 		sfx_play(&sfx.baby_infected, 1.f);
 	}
 
@@ -545,29 +687,20 @@ static void more_teepee(game_t *game, teepee_t *teepee)
 	}
 
 	for (unsigned i = 0; i < teepee->quantity; i++) {
-		teepee_icon_t	*tp;
+		assert(game->teepee_cnt < NELEMS(game->teepee_icons));
+
+		/* TODO FIXME: clean this magic number salad up, icons are laid out 16 per row from the top left */
+		game->teepee_icons[game->teepee_cnt] = (tex_instance_t){
+							.position = {
+								.x = ((game->teepee_cnt % 16) * 0.0625f) * 2.f - .9375f,
+								.y = (.9687f - ((game->teepee_cnt / 16) * 0.0625f)) * 1.9375f + -.9375f,
+							},
+							.scale = { GAME_TEEPEE_ICON_SCALE.x, GAME_TEEPEE_ICON_SCALE.y },
+							.alpha = 1.f,
+						};
 
-		tp = pad_get(game->pad, sizeof(entity_t));
-		fatal_if(!tp, "unable to allocate teepee_icon_t");
-
-		tp->entity.type = ENTITY_TYPE_TEEPEE_ICON;
-		tp->entity.scale = GAME_TEEPEE_ICON_SCALE;
-		/* TODO FIXME: clean this magic number salad up, there should probably just be a m4f_scale_scalar() wrapper for m4f_scale() that
-		 * takes a single scalar float and constructs the v3f_t{} to pass m4f_scale() using the input scalar for all dimensions... then
-		 * we'd have convenient scalars for the _SCALE defines and not these v3fs...  This works fine for now.
-		 */
-		tp->entity.node = teepee_node_new(&(stage_conf_t){ .parent = game->game_node, .name = "tp-icon", .layer = 8, .alpha = 1.f, .active = 1 }, &game->sars->projection_x, &tp->entity.model_x);
-		tp->entity.model_x = m4f_translate(NULL,
-						&(v3f_t){
-							.x = ((game->teepee_cnt % 16) * 0.0625f) * 2.f - .9375f,
-							.y = (.9687f - ((game->teepee_cnt / 16) * 0.0625f)) * 1.9375f + -.9375f,
-							.z = 0.f
-						});
-		tp->entity.model_x = m4f_scale(&tp->entity.model_x, &tp->entity.scale);
-
-		tp->next = game->teepee_head;
-		game->teepee_head = tp;
 		game->teepee_cnt++;
+		game->teepee_version++;
 		if (game->teepee_cnt >= GAME_TP_WIN_THRESHOLD)
 			game->state = GAME_STATE_OVER_WINNING;
 	}
@@ -592,6 +725,9 @@ static ix2_search_status_t baby_search(void *cb_context, ix2_object_t *ix2_objec
 	if (!stage_get_active(entity->any.node))
 		return IX2_SEARCH_MORE_MISS;
 
+	if (!entity_collides(&search->baby->entity, &entity->any))
+		return IX2_SEARCH_MORE_MISS;
+
 	switch (entity->any.type) {
 	case ENTITY_TYPE_BABY:
 		return IX2_SEARCH_MORE_MISS;
@@ -633,6 +769,9 @@ static ix2_search_status_t teepee_search(void *cb_context, ix2_object_t *ix2_obj
 	if (!stage_get_active(entity->any.node))
 		return IX2_SEARCH_MORE_MISS;
 
+	if (!entity_collides(&game->teepee->entity, &entity->any))
+		return IX2_SEARCH_MORE_MISS;
+
 	switch (entity->any.type) {
 	case ENTITY_TYPE_ADULT:
 		more_teepee(game, game->teepee);
@@ -716,6 +855,9 @@ static ix2_search_status_t maga_search(void *cb_context, ix2_object_t *ix2_objec
 	if (!stage_get_active(entity->any.node))
 		return IX2_SEARCH_MORE_MISS;
 
+	if (!entity_collides(&game->maga->entity, &entity->any))
+		return IX2_SEARCH_MORE_MISS;
+
 	switch (entity->any.type) {
 	case ENTITY_TYPE_ADULT:
 		maga_adult(game, &entity->adult, game->maga);
@@ -744,6 +886,9 @@ static ix2_search_status_t mask_search(void *cb_context, ix2_object_t *ix2_objec
 	if (!stage_get_active(entity->any.node))
 		return IX2_SEARCH_MORE_MISS;
 
+	if (!entity_collides(&game->mask->entity, &entity->any))
+		return IX2_SEARCH_MORE_MISS;
+
 	switch (entity->any.type) {
 	case ENTITY_TYPE_BABY:
 		if (stage_get_active(game->mask->entity.node))
@@ -783,6 +928,9 @@ static ix2_search_status_t virus_search(void *cb_context, ix2_object_t *ix2_obje
 	if (!stage_get_active(entity->any.node))
 		return IX2_SEARCH_MORE_MISS;
 
+	if (!entity_collides(&search->virus->entity, &entity->any))
+		return IX2_SEARCH_MORE_MISS;
+
 	switch (entity->any.type) {
 	case ENTITY_TYPE_BABY:
 		/* virus hit a baby; infect it and spawn a replacement */
@@ -880,7 +1028,7 @@ static void update_entities(play_t *play, game_t *game)
 		}
 
 		if (game->sars->cheat)
-			game->teepee->quantity = 128;
+			game->teepee->quantity = GAME_TP_MAX_QUANTITY;
 
 		bonus_node_new(&(stage_conf_t){.parent = game->game_node, .active = 1, .alpha = 1.f, .name = "teepee-bonus", .layer = 7},
 			game->teepee->quantity,
@@ -991,6 +1139,9 @@ static ix2_search_status_t adult_search(void *cb_context, ix2_object_t *ix2_obje
 	if (!stage_get_active(entity->any.node))
 		return IX2_SEARCH_MORE_MISS;
 
+	if (!entity_collides(&game->adult->entity, &entity->any))
+		return IX2_SEARCH_MORE_MISS;
+
 	switch (entity->any.type) {
 	case ENTITY_TYPE_BABY:
 		pickup_baby(game, game->adult, &entity->baby);
@@ -1095,6 +1246,8 @@ static void game_move_adult(game_t *game, v2f_t *dir)
 
 static void reset_game(play_t *play, game_t *game)
 {
+	stage_t	*icons_node;
+
 	ix2_reset(game->ix2);
 	stage_free(game->game_node);
 
@@ -1104,12 +1257,16 @@ static void reset_game(play_t *play, game_t *game)
 
 	game->babies_node = stage_new(&(stage_conf_t){ .parent = game->game_node, .name = "babies", .layer = 4, .alpha = 1.f }, NULL, NULL);
 	game->viruses_node = stage_new(&(stage_conf_t){ .parent = game->game_node, .name = "viruses", .layer = 5, .alpha = 1.f }, NULL, NULL);
-	game->score_node = stage_new(&(stage_conf_t){ .parent = game->game_node, .name = "score", .layer = 9, .alpha = 1 }, NULL, NULL);
+	game->score_node = cache_node_new(&(stage_conf_t){ .parent = game->game_node, .name = "score", .layer = 9, .alpha = 1 }, &game->score_version, &game->score_digits_node);
 
 	game->pad = pad_new(sizeof(entity_t) * 32, PAD_FLAGS_ZERO);
 
 	game->teepee_cnt = 0;
-	game->teepee_head = NULL;
+	game->teepee_time = 0.f;
+	(void) cache_node_new(&(stage_conf_t){ .parent = game->game_node, .name = "tp-icons", .layer = 8, .alpha = 1.f, .active = 1 }, &game->teepee_version, &icons_node);
+	(void) teepee_field_node_new(&(stage_conf_t){ .parent = icons_node, .name = "tp-icons-field", .alpha = 1.f, .active = 1 },
+				     &game->sars->projection_x, &game->sars->projection_version, &game->teepee_time,
+				     game->teepee_icons, &game->teepee_cnt);
 	game->flashers_on_head = game->flashers_off_head = NULL;
 	game->rescues_head = NULL;
 	game->is_maga = 0;
@@ -1142,9 +1299,10 @@ static void show_score(game_t *game)
 	for (unsigned i = 1000000000, pos = 0; i > 0; score %= i, i /= 10, pos++) {
 		unsigned	v = score / i;
 
-		digit_node_new(&(stage_conf_t){ .parent = game->score_node, .name = "score-digit", .active = 1, .alpha = 1.f }, v, &game->sars->projection_x, &game->score_digits_x[pos]);
+		digit_node_new(&(stage_conf_t){ .parent = game->score_digits_node, .name = "score-digit", .active = 1, .alpha = 1.f }, v, &game->sars->projection_x, &game->score_digits_x[pos]);
 	}
 
+	game->score_version++;
 	stage_set_active(game->score_node, 1);
 }
 
@@ -1162,7 +1320,7 @@ static void * game_init(play_t *play, int argc, char *argv[], unsigned flags)
 	game->play = play;
 	game->sars = sars;
 	game->stage = sars->stage;
-	game->plasma_node = plasma_node_new(&(stage_conf_t){ .parent = sars->stage, .name = "plasma", .alpha = 1 }, &sars->projection_x, &game->infections_rate_smoothed, &game->is_maga);
+	game->plasma_node = plasma_node_new(&(stage_conf_t){ .parent = sars->stage, .name = "plasma", .alpha = 1 }, &sars->projection_x, &sars->projection_version, &game->infections_rate_smoothed, &game->is_maga, &sars->plasma_scale, &sars->plasma_lut);
 
 	game->ix2 = ix2_new(NULL, 4, 4, 2 /* support two simultaneous searches: tv_search->baby_search */);
 
@@ -1174,18 +1332,42 @@ static void * game_init(play_t *play, int argc, char *argv[], unsigned flags)
 		game->score_digits_x[i] = m4f_scale(&game->score_digits_x[i], &GAME_DIGITS_SCALE);
 	}
 
+	for (unsigned i = 0; i < NELEMS(game_sprites); i++) {
+		ansr_tex_hint_scale(game_sprites[i].path, game_sprites[i].mask_path, game_sprites[i].scale);
+		loader_queue_ansr(game_sprites[i].path, game_sprites[i].mask_path);
+	}
+
 	sfx_init();
 
 	return game;
 }
 
 
+/* pack game_sprites[] into an atlas before they're first used, w/--atlas */
+static void game_pack(game_t *game)
+{
+	tex_atlas_stats_t	stats;
+
+	for (unsigned i = 0; i < NELEMS(game_sprites); i++)
+		tex_free(ansr_tex_new(game_sprites[i].path, game_sprites[i].mask_path));
+
+	ansr_tex_pack(&stats);
+	if (game->sars->stats)
+		fprintf(stderr, "Stats: packed %u sprites into %u %ux%u atlas page(s), %.1f%% occupied, %u standalone, %zuKiB of textures resident\n",
+			stats.n_packed, stats.n_pages, stats.page_size, stats.page_size, stats.occupancy * 100.f, stats.n_standalone, tex_resident_bytes() / 1024);
+	game->packed = 1;
+}
+
+
 static void game_enter(play_t *play, void *context)
 {
 	game_t	*game = context;
 
 	assert(game);
 
+	if (game->sars->atlas && !game->packed)
+		game_pack(game);
+
 	play_ticks_reset(play, GAME_ENTITIES_TIMER);
 	stage_set_active(game->plasma_node, 1);
 	reset_game(play, game);
@@ -1194,8 +1376,10 @@ static void game_enter(play_t *play, void *context)
 
 static void game_update(play_t *play, void *context)
 {
-	sars_t	*sars = play_context(play, SARS_CONTEXT_SARS);
-	game_t	*game = context;
+	sars_t		*sars = play_context(play, SARS_CONTEXT_SARS);
+	game_t		*game = context;
+	game_state_t	state = game->state;
+	unsigned	loads = ansr_tex_loads();
 
 	assert(game);
 	assert(sars);
@@ -1211,8 +1395,8 @@ static void game_update(play_t *play, void *context)
 			static float	velocity;
 
 			/* TODO: acceleration curve for movement?  it'd enable more precise
-			 * negotiating of obstacles, but that's not really worthwhile until there's
-			 * pixel-precision collision detection...
+			 * negotiating of obstacles, now that collisions are decided by the
+			 * collision masks rather than just the AABBs...
 			 */
 			if (key_state[SDL_SCANCODE_LEFT] || key_state[SDL_SCANCODE_A]) {
 				dir.x += -GAME_ADULT_SPEED;
@@ -1333,47 +1517,57 @@ static void game_update(play_t *play, void *context)
 		show_score(game);
 		play_music_set(play, PLAY_MUSIC_FLAG_LOOP|PLAY_MUSIC_FLAG_IDEMPOTENT, "assets/winning.ogg");
 		play_ticks_reset(play, GAME_OVER_TIMER);
+		game->teepee_time = 0.f;
+
+		/* explode the hoarded TP, every icon flies outward from the center
+		 * reaching 33X its distance after GAME_OVER_WIN_DELAY_MS.
+		 */
+		for (size_t i = 0; i < game->teepee_cnt; i++) {
+			game->teepee_icons[i].velocity = (v2f_t){
+								.x = game->teepee_icons[i].position.x * 32.f / (float)GAME_OVER_WIN_DELAY_MS,
+								.y = game->teepee_icons[i].position.y * 32.f / (float)GAME_OVER_WIN_DELAY_MS,
+							};
+		}
+
 		game->state = GAME_STATE_OVER_WINNING_DELAY;
 		break;
 
-	case GAME_STATE_OVER_WINNING_DELAY: {
-		float		t = (float)(play_ticks(play, GAME_OVER_TIMER) * 1.f / (float)GAME_OVER_WIN_DELAY_MS);
-		teepee_icon_t	*tp = game->teepee_head;
-
-		if (t > 1.f) {
-			game->state = GAME_STATE_OVER_WINNING_WAITING;
+	case GAME_STATE_OVER_WINNING_DELAY:
+		/* the icons' cache can't help while they're all moving */
+		game->teepee_time = (float)play_ticks(play, GAME_OVER_TIMER);
+		game->teepee_version++;
+		if (game->teepee_time <= (float)GAME_OVER_WIN_DELAY_MS)
 			break;
-		}
 
-		/* explode the hoarded TP */
-		for (size_t i = 0; tp != NULL; tp = tp->next, i++) {
-			tp->entity.model_x = m4f_translate(NULL,
-							&(v3f_t){
-								.x = (((i % 16) * 0.0625f) * 2.f - .9375f) * (1.f + t * 32.f),
-								.y = ((.9687f - ((i / 16) * 0.0625f)) * 1.9375f + -.9375f) * (1.f + t * 32.f),
-								.z = 0.f
-							});
-			tp->entity.model_x = m4f_scale(&tp->entity.model_x, &tp->entity.scale);
+		/* rain the TP down in columns wrapping around forever, rocking side
+		 * to side in sync w/the adult's dance.  The timer keeps running, so
+		 * they start where they'd be at teepee_time.
+		 */
+		for (size_t i = 0; i < game->teepee_cnt; i++) {
+			game->teepee_icons[i] = (tex_instance_t){
+							.position = {
+								.x = ((i % 16) * 0.0625f) * 2.f - .9375f,
+								.y = 1.5f - (i / 16 * 0.0625f) * 3.f,
+							},
+							.scale = game->teepee_icons[i].scale,
+							.alpha = 1.f,
+							.swing = 1.f,
+							.velocity = { 0.f, -.0003f },
+							.wrap = { 0.f, 1.5f },
+							.rate = .005f,
+						};
 		}
+
+		game->state = GAME_STATE_OVER_WINNING_WAITING;
 		break;
-	}
 
 	case GAME_STATE_OVER_WINNING_WAITING: {
-		teepee_icon_t	*tp = game->teepee_head;
-		float		t = (float)(play_ticks(play, GAME_OVER_TIMER) % 6283) * .005f;
-		float		r = sinf(t);
-
-		/* just do nothing while animating the teepee icons, waiting for a keypress of some kind */
-		for (size_t i = 0; tp != NULL; tp = tp->next, i++) {
-			tp->entity.model_x = m4f_translate(NULL,
-							&(v3f_t){
-								.x = ((i % 16) * 0.0625f) * 2.f - .9375f,
-								.y = ((1.f - fmod((i / 16 * 0.0625f) + (float)(play_ticks(play, GAME_OVER_TIMER) % 10000) * .0001f, 1.f))) * 3.f - 1.5f,
-								.z = 0.f
-							});
-			tp->entity.model_x = m4f_scale(&tp->entity.model_x, &tp->entity.scale);
-			tp->entity.model_x = m4f_rotate(&tp->entity.model_x, &(v3f_t){ .x = 0.f, .y = 0.f, .z = 1.f }, r);
-		}
+		float		r;
+
+		/* just do nothing while the teepee icons animate themselves, waiting for a keypress of some kind */
+		game->teepee_time = (float)play_ticks(play, GAME_OVER_TIMER);
+		game->teepee_version++;
+		r = sinf(game->teepee_time * .005f);
 
 		/* "dance" the adult too */
 		game->adult->entity.model_x = m4f_translate(NULL, &(v3f_t){ game->adult->entity.position.x, game->adult->entity.position.y, 0.f });
@@ -1405,6 +1599,10 @@ static void game_update(play_t *play, void *context)
 		assert(0);
 	}
 
+	/* any decoding or uploading here hitches the game, see game_sprites[] */
+	warn_if(state == GAME_STATE_PLAYING && ansr_tex_loads() != loads,
+		"%u sprite(s) loaded while playing, missing from game_sprites[]?", ansr_tex_loads() - loads);
+
 	/* always dirty the stage in the game context */
 	stage_dirty(sars->stage);
 }
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gl-ext.h"
+#include "macros.h"
+
+gl_ext_t	gl_ext;
+
+
+/* parse the GL_VERSION string, desktop versions start w/the number while GLES
+ * ones are prefixed by "OpenGL ES ", and WebGL reports versions like
+ * "WebGL 1.0 (OpenGL ES 2.0 Chromium)".
+ */
+static void gl_ext_version(const char *version, int *res_es, int *res_major, int *res_minor)
+{
+	const char	*es, *webgl;
+
+	*res_es = *res_major = *res_minor = 0;
+	if (!version)
+		return;
+
+	es = strstr(version, "OpenGL ES ");
+	webgl = strstr(version, "WebGL ");
+	if (es) {
+		*res_es = 1;
+		(void) sscanf(es + strlen("OpenGL ES "), "%d.%d", res_major, res_minor);
+	} else if (webgl) {
+		/* WebGL 1 is GLES 2.0, WebGL 2 is GLES 3.0 */
+		*res_es = 1;
+		*res_major = atoi(webgl + strlen("WebGL ")) + 1;
+	} else {
+		(void) sscanf(version, "%d.%d", res_major, res_minor);
+	}
+}
+
+
+/* must be called with the GL context current, after gladLoadGLES2Loader() */
+void gl_ext_init(void)
+{
+	int	es, major, minor;
+
+	gl_ext_version((const char *)glGetString(GL_VERSION), &es, &major, &minor);
+
+	if (SDL_GL_ExtensionSupported("GL_ARB_sync")) {
+		gl_ext.FenceSync = SDL_GL_GetProcAddress("glFenceSync");
+		gl_ext.ClientWaitSync = SDL_GL_GetProcAddress("glClientWaitSync");
+		gl_ext.DeleteSync = SDL_GL_GetProcAddress("glDeleteSync");
+	} else if (SDL_GL_ExtensionSupported("GL_APPLE_sync")) {
+		gl_ext.FenceSync = SDL_GL_GetProcAddress("glFenceSyncAPPLE");
+		gl_ext.ClientWaitSync = SDL_GL_GetProcAddress("glClientWaitSyncAPPLE");
+		gl_ext.DeleteSync = SDL_GL_GetProcAddress("glDeleteSyncAPPLE");
+	}
+	gl_ext.sync = gl_ext.FenceSync && gl_ext.ClientWaitSync && gl_ext.DeleteSync;
+
+	/* desktop GL has mipmapped NPOT textures since 2.0 and GLES since 3.0 */
+	gl_ext.npot_mipmap = !es || major >= 3 || SDL_GL_ExtensionSupported("GL_OES_texture_npot");
+
+	if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+		gl_ext.GetProgramBinary = SDL_GL_GetProcAddress("glGetProgramBinary");
+		gl_ext.ProgramBinary = SDL_GL_GetProcAddress("glProgramBinary");
+		gl_ext.ProgramParameteri = SDL_GL_GetProcAddress("glProgramParameteri");
+	} else if (SDL_GL_ExtensionSupported("GL_OES_get_program_binary")) {
+		gl_ext.GetProgramBinary = SDL_GL_GetProcAddress("glGetProgramBinaryOES");
+		gl_ext.ProgramBinary = SDL_GL_GetProcAddress("glProgramBinaryOES");
+	}
+
+	/* drivers may advertise the extension yet support no formats */
+	if (gl_ext.GetProgramBinary && gl_ext.ProgramBinary) {
+		GLint	n_formats = 0;
+
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+		gl_ext.program_binary = n_formats > 0;
+	}
+
+	/* vertex array objects are core in GL 3.0 and GLES 3.0 */
+	if (major >= 3 || SDL_GL_ExtensionSupported("GL_ARB_vertex_array_object")) {
+		gl_ext.GenVertexArrays = SDL_GL_GetProcAddress("glGenVertexArrays");
+		gl_ext.BindVertexArray = SDL_GL_GetProcAddress("glBindVertexArray");
+		gl_ext.DeleteVertexArrays = SDL_GL_GetProcAddress("glDeleteVertexArrays");
+	} else if (SDL_GL_ExtensionSupported("GL_OES_vertex_array_object")) {
+		gl_ext.GenVertexArrays = SDL_GL_GetProcAddress("glGenVertexArraysOES");
+		gl_ext.BindVertexArray = SDL_GL_GetProcAddress("glBindVertexArrayOES");
+		gl_ext.DeleteVertexArrays = SDL_GL_GetProcAddress("glDeleteVertexArraysOES");
+	}
+	gl_ext.vertex_array_object = gl_ext.GenVertexArrays && gl_ext.BindVertexArray && gl_ext.DeleteVertexArrays;
+
+	/* per-instance attributes are core in GL 3.3 and GLES 3.0 */
+	if (es ? major >= 3 : (major > 3 || (major == 3 && minor >= 3))) {
+		gl_ext.DrawArraysInstanced = SDL_GL_GetProcAddress("glDrawArraysInstanced");
+		gl_ext.VertexAttribDivisor = SDL_GL_GetProcAddress("glVertexAttribDivisor");
+	} else if (SDL_GL_ExtensionSupported("GL_ARB_instanced_arrays")) {
+		gl_ext.DrawArraysInstanced = SDL_GL_GetProcAddress("glDrawArraysInstancedARB");
+		gl_ext.VertexAttribDivisor = SDL_GL_GetProcAddress("glVertexAttribDivisorARB");
+	} else if (SDL_GL_ExtensionSupported("GL_ANGLE_instanced_arrays")) {
+		gl_ext.DrawArraysInstanced = SDL_GL_GetProcAddress("glDrawArraysInstancedANGLE");
+		gl_ext.VertexAttribDivisor = SDL_GL_GetProcAddress("glVertexAttribDivisorANGLE");
+	} else if (SDL_GL_ExtensionSupported("GL_EXT_instanced_arrays")) {
+		gl_ext.DrawArraysInstanced = SDL_GL_GetProcAddress("glDrawArraysInstancedEXT");
+		gl_ext.VertexAttribDivisor = SDL_GL_GetProcAddress("glVertexAttribDivisorEXT");
+	}
+	gl_ext.instanced_arrays = gl_ext.DrawArraysInstanced && gl_ext.VertexAttribDivisor;
+
+	debugf("GL extensions: sync=%u npot_mipmap=%u program_binary=%u vertex_array_object=%u instanced_arrays=%u",
+		gl_ext.sync, gl_ext.npot_mipmap, gl_ext.program_binary, gl_ext.vertex_array_object, gl_ext.instanced_arrays);
+}
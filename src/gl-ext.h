@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GL_EXT_H
+#define _GL_EXT_H
+
+#include "glad.h"
+
+/* glad only provides plain GLES 2.0, anything optional beyond that gets
+ * looked up here at runtime.  Check the flag before using the pointers.
+ */
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE	0x9117
+#define GL_ALREADY_SIGNALED		0x911A
+#define GL_TIMEOUT_EXPIRED		0x911B
+#define GL_CONDITION_SATISFIED		0x911C
+#define GL_WAIT_FAILED			0x911D
+#define GL_SYNC_FLUSH_COMMANDS_BIT	0x00000001
+#define GL_TIMEOUT_IGNORED		0xFFFFFFFFFFFFFFFFull
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#define GL_PROGRAM_BINARY_LENGTH		0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+#endif
+
+typedef struct gl_ext_t {
+	unsigned	sync:1;		/* ARB_sync / APPLE_sync fences */
+	unsigned	npot_mipmap:1;	/* mipmapping non-power-of-two textures, OES_texture_npot on GLES 2.0 */
+	unsigned	program_binary:1; /* ARB_get_program_binary / OES_get_program_binary w/at least one format */
+	unsigned	vertex_array_object:1; /* GL 3.0 / GLES 3.0 / ARB_vertex_array_object / OES_vertex_array_object */
+	unsigned	instanced_arrays:1; /* GL 3.3 / GLES 3.0 / ARB_, ANGLE_ or EXT_instanced_arrays */
+
+	GLsync		(APIENTRYP FenceSync)(GLenum condition, GLbitfield flags);
+	GLenum		(APIENTRYP ClientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+	void		(APIENTRYP DeleteSync)(GLsync sync);
+
+	void		(APIENTRYP GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+	void		(APIENTRYP ProgramBinary)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+	void		(APIENTRYP ProgramParameteri)(GLuint program, GLenum pname, GLint value); /* ARB only, may be NULL */
+
+	void		(APIENTRYP GenVertexArrays)(GLsizei n, GLuint *arrays);
+	void		(APIENTRYP BindVertexArray)(GLuint array);
+	void		(APIENTRYP DeleteVertexArrays)(GLsizei n, const GLuint *arrays);
+
+	void		(APIENTRYP DrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+	void		(APIENTRYP VertexAttribDivisor)(GLuint index, GLuint divisor);
+} gl_ext_t;
+
+extern gl_ext_t	gl_ext;
+
+void gl_ext_init(void);
+
+#endif
@@ -0,0 +1,350 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Shadows the render context's GL state, skipping the calls which wouldn't
+ * change anything.  This only works as long as everything rendering on that
+ * context changes this state through here, or puts back what it changed.
+ * Nothing is bound back to 0 after drawing anymore, the next draw just binds
+ * over whatever differs.
+ *
+ * Texture uploads may happen on another thread's context sharing objects w/the
+ * render context, those must not come through here and restore the bindings
+ * they disturb instead, see tex_upload_lod().
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "gl-ext.h"
+#include "gl-state.h"
+#include "glad.h"
+#include "m4f.h"
+#include "macros.h"
+
+#define GL_STATE_MAX_UNITS	4
+#define GL_STATE_MAX_UNIFORMS	4
+
+/* the versions of a program's uniforms uploaded by gl_state_uniform_m4f() */
+typedef struct gl_state_program_t gl_state_program_t;
+struct gl_state_program_t {
+	gl_state_program_t	*next;
+	unsigned		program, n_uniforms;
+	struct {
+		int		location;
+		unsigned	version;
+	}			uniforms[GL_STATE_MAX_UNIFORMS];
+};
+
+static struct {
+	unsigned		program, array_buffer;
+	unsigned		unit, textures[GL_STATE_MAX_UNITS];
+	unsigned		blend:1;
+	unsigned		blend_src, blend_dest;
+	gl_state_vertex_array_t	*vertex_array;
+	unsigned		enabled;	/* attribute locations enabled w/o vertex array objects */
+	unsigned		divisors;	/* attribute locations advancing per instance, likewise */
+	unsigned		version;
+	gl_state_program_t	*programs;
+	unsigned		changes, skipped;
+} gl_state = {
+	.blend_src = GL_ONE,
+	.blend_dest = GL_ZERO,
+};
+
+
+void gl_state_use_program(unsigned program)
+{
+	if (program == gl_state.program) {
+		gl_state.skipped++;
+		return;
+	}
+
+	glUseProgram(program);
+	gl_state.program = program;
+	gl_state.changes++;
+}
+
+
+/* delete program, forgetting its uniform versions before its name gets reused */
+void gl_state_delete_program(unsigned program)
+{
+	for (gl_state_program_t **p = &gl_state.programs; *p; p = &(*p)->next) {
+		gl_state_program_t	*victim = *p;
+
+		if (victim->program != program)
+			continue;
+
+		*p = victim->next;
+		free(victim);
+		break;
+	}
+
+	if (program == gl_state.program)
+		gl_state_use_program(0);
+
+	glDeleteProgram(program);
+}
+
+
+void gl_state_bind_array_buffer(unsigned buffer)
+{
+	if (buffer == gl_state.array_buffer) {
+		gl_state.skipped++;
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	gl_state.array_buffer = buffer;
+	gl_state.changes++;
+}
+
+
+/* bind texture to unit's GL_TEXTURE_2D, the active unit is left wherever it ends up */
+void gl_state_bind_texture(unsigned unit, unsigned texture)
+{
+	assert(unit < GL_STATE_MAX_UNITS);
+
+	if (texture == gl_state.textures[unit]) {
+		gl_state.skipped++;
+		return;
+	}
+
+	if (unit != gl_state.unit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		gl_state.unit = unit;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	gl_state.textures[unit] = texture;
+	gl_state.changes++;
+}
+
+
+/* delete texture, GL unbinds it from the units it's bound to in this context */
+void gl_state_delete_texture(unsigned texture)
+{
+	for (unsigned i = 0; i < GL_STATE_MAX_UNITS; i++) {
+		if (gl_state.textures[i] == texture)
+			gl_state.textures[i] = 0;
+	}
+
+	glDeleteTextures(1, &texture);
+}
+
+
+static void gl_state_attributes(const gl_state_vertex_array_t *array)
+{
+	for (unsigned i = 0; i < array->n_attributes; i++) {
+		int	instanced = array->attributes[i].instanced;
+
+		if (array->attributes[i].location < 0)
+			continue;
+
+		gl_state_bind_array_buffer(instanced ? array->instance_buffer : array->buffer);
+		glVertexAttribPointer(array->attributes[i].location, array->attributes[i].size, GL_FLOAT, GL_FALSE,
+				      instanced ? array->instance_stride : array->stride, (void *)array->attributes[i].offset);
+	}
+}
+
+
+/* bind array's buffer and attributes for drawing, NULL for none.  With vertex
+ * array objects array can't be changed after its first bind.
+ */
+void gl_state_bind_vertex_array(gl_state_vertex_array_t *array)
+{
+	unsigned	enabled = 0;
+
+	assert(!array || array->n_attributes <= GL_STATE_MAX_ATTRIBUTES);
+
+	if (array == gl_state.vertex_array) {
+		gl_state.skipped++;
+		return;
+	}
+
+	gl_state.vertex_array = array;
+	gl_state.changes++;
+
+	if (gl_ext.vertex_array_object) {
+		if (!array) {
+			gl_ext.BindVertexArray(0);
+			return;
+		}
+
+		if (array->vao) {
+			gl_ext.BindVertexArray(array->vao);
+			return;
+		}
+
+		gl_ext.GenVertexArrays(1, &array->vao);
+		gl_ext.BindVertexArray(array->vao);
+		gl_state_attributes(array);
+
+		for (unsigned i = 0; i < array->n_attributes; i++) {
+			if (array->attributes[i].location < 0)
+				continue;
+
+			glEnableVertexAttribArray(array->attributes[i].location);
+			if (array->attributes[i].instanced)
+				gl_ext.VertexAttribDivisor(array->attributes[i].location, 1);
+		}
+
+		return;
+	}
+
+	/* without them, just enable and disable the locations that differ */
+	if (array) {
+		gl_state_attributes(array);
+
+		for (unsigned i = 0; i < array->n_attributes; i++) {
+			int		location = array->attributes[i].location;
+			unsigned	bit;
+
+			if (location < 0)
+				continue;
+
+			assert(location < 32);
+			bit = 1u << location;
+			enabled |= bit;
+
+			if (!array->attributes[i].instanced != !(gl_state.divisors & bit)) {
+				gl_ext.VertexAttribDivisor(location, array->attributes[i].instanced ? 1 : 0);
+				gl_state.divisors ^= bit;
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < 32; i++) {
+		unsigned	bit = 1u << i;
+
+		if ((enabled & bit) && !(gl_state.enabled & bit))
+			glEnableVertexAttribArray(i);
+		else if (!(enabled & bit) && (gl_state.enabled & bit))
+			glDisableVertexAttribArray(i);
+	}
+	gl_state.enabled = enabled;
+}
+
+
+/* release array's vertex array object, if it got one */
+void gl_state_vertex_array_fini(gl_state_vertex_array_t *array)
+{
+	assert(array);
+
+	if (array == gl_state.vertex_array)
+		gl_state_bind_vertex_array(NULL);
+
+	if (array->vao) {
+		gl_ext.DeleteVertexArrays(1, &array->vao);
+		array->vao = 0;
+	}
+}
+
+
+/* enable blending w/the src and dest factors for the color.  The alpha always
+ * accumulates coverage as GL_ONE, GL_ONE_MINUS_SRC_ALPHA, so whatever gets
+ * rendered into a texture can be composited w/premultiplied alpha.
+ */
+void gl_state_blend(unsigned src, unsigned dest)
+{
+	if (gl_state.blend && src == gl_state.blend_src && dest == gl_state.blend_dest) {
+		gl_state.skipped++;
+		return;
+	}
+
+	if (!gl_state.blend) {
+		glEnable(GL_BLEND);
+		gl_state.blend = 1;
+	}
+
+	if (src != gl_state.blend_src || dest != gl_state.blend_dest) {
+		glBlendFuncSeparate(src, dest, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		gl_state.blend_src = src;
+		gl_state.blend_dest = dest;
+	}
+
+	gl_state.changes++;
+}
+
+
+/* returns a new version number for tagging values passed to gl_state_uniform_m4f(),
+ * whoever owns the value takes a new one whenever it changes.  Never 0.
+ */
+unsigned gl_state_version(void)
+{
+	if (!++gl_state.version)
+		gl_state.version++;
+
+	return gl_state.version;
+}
+
+
+/* upload m4f to the current program's uniform at location, unless it already
+ * has this version of it.  A version of 0 always uploads, and every upload to
+ * location must come through here for the versions to mean anything.
+ */
+void gl_state_uniform_m4f(int location, const m4f_t *m4f, unsigned version)
+{
+	gl_state_program_t	*p;
+	unsigned		i;
+
+	assert(m4f);
+
+	if (location < 0)
+		return;
+
+	if (!version)
+		goto upload;
+
+	for (p = gl_state.programs; p && p->program != gl_state.program; p = p->next);
+	if (!p) {
+		p = calloc(1, sizeof(gl_state_program_t));
+		fatal_if(!p, "unable to allocate gl_state_program_t");
+
+		p->program = gl_state.program;
+		p->next = gl_state.programs;
+		gl_state.programs = p;
+	}
+
+	for (i = 0; i < p->n_uniforms && p->uniforms[i].location != location; i++);
+	if (i < p->n_uniforms && p->uniforms[i].version == version) {
+		gl_state.skipped++;
+		return;
+	}
+
+	if (i == p->n_uniforms) {
+		if (i == GL_STATE_MAX_UNIFORMS)
+			goto upload;
+
+		p->uniforms[i].location = location;
+		p->n_uniforms++;
+	}
+	p->uniforms[i].version = version;
+
+upload:
+	glUniformMatrix4fv(location, 1, GL_FALSE, &m4f->m[0][0]);
+	gl_state.changes++;
+}
+
+
+/* the number of state changes issued and skipped as redundant, so far */
+void gl_state_stats(unsigned *res_changes, unsigned *res_skipped)
+{
+	if (res_changes)
+		*res_changes = gl_state.changes;
+
+	if (res_skipped)
+		*res_skipped = gl_state.skipped;
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GL_STATE_H
+#define _GL_STATE_H
+
+#include <stddef.h>
+
+#define GL_STATE_MAX_ATTRIBUTES	8
+
+typedef struct m4f_t m4f_t;
+
+/* how a program's float attributes are interleaved in a vertex buffer, and
+ * optionally an instance buffer advancing once per instance for instanced
+ * draws.  This becomes a vertex array object on its first bind when those are
+ * supported.
+ */
+typedef struct gl_state_vertex_array_t {
+	unsigned	vao;
+	unsigned	buffer, instance_buffer;
+	int		stride, instance_stride;
+	unsigned	n_attributes;
+	struct {
+		int	location;	/* skipped when < 0 */
+		int	size;		/* in floats */
+		size_t	offset;
+		int	instanced;	/* in instance_buffer, requires gl_ext.instanced_arrays */
+	}		attributes[GL_STATE_MAX_ATTRIBUTES];
+} gl_state_vertex_array_t;
+
+void gl_state_use_program(unsigned program);
+void gl_state_delete_program(unsigned program);
+void gl_state_bind_array_buffer(unsigned buffer);
+void gl_state_bind_texture(unsigned unit, unsigned texture);
+void gl_state_delete_texture(unsigned texture);
+void gl_state_bind_vertex_array(gl_state_vertex_array_t *array);
+void gl_state_vertex_array_fini(gl_state_vertex_array_t *array);
+void gl_state_blend(unsigned src, unsigned dest);
+unsigned gl_state_version(void);
+void gl_state_uniform_m4f(int location, const m4f_t *m4f, unsigned version);
+void gl_state_stats(unsigned *res_changes, unsigned *res_skipped);
+
+#endif
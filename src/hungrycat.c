@@ -16,16 +16,20 @@
 
 #include <SDL.h>
 #include <assert.h>
+#include <limits.h>
 
 #include <play.h>
 #include <stage.h>
 
+#include "ansr-tex.h"
 #include "glad.h"
 #include "hungrycat-node.h"
+#include "loader.h"
 #include "m4f.h"
 #include "m4f-3dx.h"
 #include "macros.h"
 #include "sars.h"
+#include "shader.h"
 
 #define HUNGRYCAT_FADE_MS	3333
 
@@ -152,15 +156,35 @@ static void hungrycat_update(play_t *play, void *context)
 
 static void hungrycat_leave(play_t *play, void *context)
 {
+	sars_t		*sars = play_context(play, SARS_CONTEXT_SARS);
 	hungrycat_t	*hungrycat = context;
+	Uint64		warmup_start;
+	unsigned	n_warmed;
 
 	assert(hungrycat);
 
+	/* the game needs whatever's left now, a no-op with loader threads */
+	(void) loader_slice(0, UINT_MAX);
+
+	/* every program the game uses exists by now; the plasma's from game_init(),
+	 * and tex.c's for the sprites' format (instanced and premultiplied included)
+	 * from loading the splash.  Get them fully compiled before the first frame
+	 * of gameplay rather than on their first draw.
+	 */
+	warmup_start = SDL_GetPerformanceCounter();
+	n_warmed = shader_warmup();
+	if (sars->stats)
+		fprintf(stderr, "Stats: warmed up %u shader programs in %.2fms\n",
+			n_warmed, (double)(SDL_GetPerformanceCounter() - warmup_start) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+
 	/* we never reenter this context since it's just a splash, so
 	 * the context leave is effectively the shutdown, cleanup.
 	 */
 	stage_free(hungrycat->node);
 	free(hungrycat);
+
+	/* the splash texture is unused from here on */
+	(void) ansr_tex_evict();
 	/* XXX: this is icky though, play_context(SARS_CONTEXT_HUNGRYCAT) will
 	 * return a dangling pointer!  Not that it occurs anywhere though.
 	 */
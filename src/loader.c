@@ -0,0 +1,778 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The loader decodes assets on a pool of worker threads so the work can
+ * overlap with the hungrycat splash already being on-screen.
+ *
+ * Workers only ever produce CPU-side results; an ansr_view_t for sprites
+ * (or an ansr_cells_t for ANSR_TEX_FORMAT_CELLS) and a Mix_Chunk for sfx.  Anything involving GL, i.e. tex_new(), is left
+ * for loader_service() which must be called regularly from the GL thread,
+ * sars_render() takes care of that.  It's also where the Mix_Chunk gets
+ * stored at the queuer's res_chunk, so sfx.c never sees a half-loaded sound.
+ *
+ * Finished sprites sit in the loader until claimed by ansr_tex_new() via
+ * loader_take_tex(), which also waits on (or just does) any decode still
+ * outstanding for the requested sprite, so queueing something never changes
+ * the outcome of loading it - only when the work happens.
+ *
+ * With zero threads (emscripten), nothing happens in the background.  Instead
+ * loader_slice() advances the work cooperatively in steps until its time budget
+ * is spent, called from sars_render() to load behind the splash at a steady
+ * frame rate.  A step is small and bounded; feeding a chunk of a .ans file to
+ * ansr, rasterizing a few glyph rows of a mask or image, or uploading a texture.
+ *
+ * When given a window, the loader also tries to create a second GL context
+ * sharing objects with the render context, for an upload thread which takes
+ * the decoded sprites through glTexImage2D() and fences them.  Then all that's
+ * left for loader_service() is noticing the signaled fences and wrapping the
+ * texture names in tex_t.  Without context sharing (or the upload thread failing
+ * to make its context current), the uploads just happen in loader_service().
+ *
+ * Sprites already loaded get relevelled the same way when a resize calls for a
+ * different lod, see loader_queue_relevel().  Those jobs hand their texture to
+ * ansr_tex_releveled() instead of waiting to be taken, and are freed once done.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ansr-tex.h"
+#include "ansr-view.h"
+#include "gl-ext.h"
+#include "gl-state.h"
+#include "loader.h"
+#include "macros.h"
+#include "tex.h"
+
+#define LOADER_MAX_THREADS	8
+
+typedef enum loader_job_type_t {
+	LOADER_JOB_TYPE_ANSR,
+	LOADER_JOB_TYPE_WAV,
+} loader_job_type_t;
+
+typedef enum loader_job_state_t {
+	LOADER_JOB_STATE_QUEUED,	/* waiting for a worker */
+	LOADER_JOB_STATE_RUNNING,	/* being decoded */
+	LOADER_JOB_STATE_DECODED,	/* decoded, waiting for upload thread or loader_service() */
+	LOADER_JOB_STATE_UPLOADING,	/* being uploaded by the upload thread */
+	LOADER_JOB_STATE_UPLOADED,	/* uploaded, waiting for fence in loader_service() */
+	LOADER_JOB_STATE_DONE,		/* finished, tex waiting to be taken if ANSR */
+} loader_job_state_t;
+
+typedef struct loader_job_t loader_job_t;
+
+struct loader_job_t {
+	loader_job_t		*next;
+	loader_job_type_t	type;
+	loader_job_state_t	state;
+	const char		*path, *mask_path;
+
+	ansr_view_job_t		*view_job;	/* cooperative rasterization in progress */
+	ansr_view_t		*view;
+	ansr_cells_t		*cells;		/* instead of view for ANSR_TEX_FORMAT_CELLS */
+	unsigned		uploaded;	/* texture name in ansr_tex_format() */
+	int			uploaded_width, uploaded_height;
+	unsigned		uploaded_lod;
+	int			draw_width, draw_height;	/* for the lod, snapshotted when queued */
+	ansr_view_bounds_t	bounds;		/* of the opaque pixels, found before the view's freed */
+	GLsync			fence;		/* completion of uploaded, if gl_ext.sync */
+	tex_t			*tex;
+	unsigned		taken:1;
+	unsigned		relevel:1;	/* for ansr_tex_releveled(), owns path + mask_path */
+
+	Mix_Chunk		*chunk, **res_chunk;
+};
+
+static struct {
+	SDL_mutex	*mutex;
+	SDL_cond	*cond;	/* signaled on new jobs and on jobs becoming decoded */
+	loader_job_t	*head, *tail;
+	unsigned	n_threads;
+	unsigned	n_pending;	/* jobs not yet LOADER_JOB_STATE_DONE */
+	unsigned	n_frames;	/* loader_service() calls w/jobs pending */
+	loader_job_t	*slice_job;	/* job being advanced by loader_slice() */
+
+	SDL_Window	*upload_window;
+	SDL_GLContext	upload_gl;
+	unsigned	uploader:1;	/* upload thread is running */
+} loader;
+
+
+/* the CPU side of a job, called without the lock held */
+static void loader_decode(loader_job_t *job)
+{
+	switch (job->type) {
+	case LOADER_JOB_TYPE_ANSR:
+		if (ansr_tex_format() == ANSR_TEX_FORMAT_CELLS)
+			job->cells = ansr_tex_decode_cells(job->path, job->mask_path);
+		else
+			job->view = ansr_tex_decode(job->path, job->mask_path);
+		break;
+
+	case LOADER_JOB_TYPE_WAV:
+		job->chunk = Mix_LoadWAV(job->path);
+		warn_if(!job->chunk, "unable to load \"%s\": %s", job->path, Mix_GetError());
+		break;
+
+	default:
+		assert(0);
+	}
+}
+
+
+/* create the texture for a decoded ANSR job in ansr_tex_format(), called
+ * without the lock held from whichever thread is doing the upload.
+ */
+static void loader_upload_tex(loader_job_t *job)
+{
+	unsigned char	*indices;
+
+	switch (ansr_tex_format()) {
+	case ANSR_TEX_FORMAT_CELLS:
+		ansr_cells_bounds(job->cells, &job->bounds);
+		job->uploaded = tex_upload_cells(job->cells->width, job->cells->height, job->cells->cells);
+		job->uploaded_width = job->cells->width;
+		job->uploaded_height = job->cells->height;
+		job->cells = ansr_cells_free(job->cells);
+		return;
+
+	case ANSR_TEX_FORMAT_INDEXED:
+		indices = ansr_view_indices(job->view);
+		fatal_if(!indices, "unable to allocate indices for \"%s\"", job->path);
+		job->uploaded = tex_upload_indexed(job->view->width, job->view->height, indices);
+		free(indices);
+		break;
+
+	case ANSR_TEX_FORMAT_RGBA:
+		job->uploaded_lod = ansr_tex_lod(job->view->width, job->view->height, job->draw_width, job->draw_height);
+		job->uploaded = tex_upload_lod(job->view->width, job->view->height, (const unsigned char *)job->view->pixels, job->uploaded_lod);
+		break;
+
+	default:
+		assert(0);
+	}
+
+	ansr_view_bounds(job->view->width, job->view->height, job->view->pixels, &job->bounds);
+	job->uploaded_width = job->view->width;
+	job->uploaded_height = job->view->height;
+	job->view = ansr_view_free(job->view);
+}
+
+
+/* upload a decoded ANSR job, called without the lock held from the upload thread */
+static void loader_upload(loader_job_t *job)
+{
+	loader_upload_tex(job);
+
+	/* without fences there's no way for the GL thread to tell when the upload
+	 * has landed, so just wait for it here.
+	 */
+	if (gl_ext.sync) {
+		job->fence = gl_ext.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+	} else {
+		glFinish();
+	}
+}
+
+
+/* check if an uploaded job's fence has signaled, optionally waiting for it,
+ * called without the lock held from the GL thread.
+ */
+static int loader_uploaded(loader_job_t *job, int wait)
+{
+	GLenum	res;
+
+	if (!job->fence)
+		return 1;
+
+	res = gl_ext.ClientWaitSync(job->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+	if (res == GL_TIMEOUT_EXPIRED)
+		return 0;
+
+	warn_if(res == GL_WAIT_FAILED, "wait on upload fence failed for \"%s\"", job->path);
+	gl_ext.DeleteSync(job->fence);
+	job->fence = NULL;
+
+	return 1;
+}
+
+
+/* the GL side of a job, called without the lock held from the GL thread */
+static void loader_finish(loader_job_t *job)
+{
+	switch (job->type) {
+	case LOADER_JOB_TYPE_ANSR:
+		if (!job->uploaded)
+			loader_upload_tex(job);
+
+		if (job->relevel) {
+			if (!ansr_tex_releveled(job->path, job->mask_path, job->uploaded, job->uploaded_lod))
+				gl_state_delete_texture(job->uploaded);
+			job->uploaded = 0;
+			break;
+		}
+
+		switch (ansr_tex_format()) {
+		case ANSR_TEX_FORMAT_CELLS:
+			job->tex = tex_new_cells_uploaded(job->uploaded, job->uploaded_width, job->uploaded_height);
+			break;
+
+		case ANSR_TEX_FORMAT_INDEXED:
+			job->tex = tex_new_indexed_uploaded(job->uploaded, job->uploaded_width, job->uploaded_height);
+			break;
+
+		default:
+			job->tex = tex_new_uploaded(job->uploaded, job->uploaded_width, job->uploaded_height, job->uploaded_lod);
+		}
+		fatal_if(!job->tex, "unable to create tex for \"%s\"", job->path);
+		job->uploaded = 0;
+		break;
+
+	case LOADER_JOB_TYPE_WAV:
+		*job->res_chunk = job->chunk;
+		break;
+
+	default:
+		assert(0);
+	}
+}
+
+
+/* advance a job by one bounded step in cooperative mode, called without the
+ * lock held from the GL thread.  Returns 1 when the job is finished.
+ */
+static int loader_step(loader_job_t *job, unsigned n_rows)
+{
+	switch (job->type) {
+	case LOADER_JOB_TYPE_ANSR:
+		if (job->view || job->cells) {
+			loader_finish(job);
+
+			return 1;
+		}
+
+		if (ansr_tex_format() == ANSR_TEX_FORMAT_CELLS) {
+			/* there's no rasterizing to spread out, just parsing */
+			job->cells = ansr_tex_decode_cells(job->path, job->mask_path);
+
+			return 0;
+		}
+
+		if (!job->view_job) {
+			/* embedded and baked sprites are cheap enough to take in one step */
+			job->view = ansr_tex_decode_prebuilt(job->path, job->mask_path);
+			if (!job->view)
+				job->view_job = ansr_view_job_new(job->path, job->mask_path);
+
+			return 0;
+		}
+
+		if (ansr_view_job_step(job->view_job, n_rows)) {
+			job->view = ansr_view_job_finish(job->view_job, NULL);
+			job->view_job = NULL;
+		}
+
+		return 0;
+
+	case LOADER_JOB_TYPE_WAV:
+		loader_decode(job);
+		loader_finish(job);
+
+		return 1;
+
+	default:
+		assert(0);
+	}
+
+	return 1;
+}
+
+
+/* claim the oldest queued job, called with the lock held */
+static loader_job_t * loader_claim(void)
+{
+	for (loader_job_t *job = loader.head; job; job = job->next) {
+		if (job->state == LOADER_JOB_STATE_QUEUED) {
+			job->state = LOADER_JOB_STATE_RUNNING;
+
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+
+/* decode a claimed job, called with the lock held and returns with it held */
+static void loader_run(loader_job_t *job)
+{
+	assert(job->state == LOADER_JOB_STATE_RUNNING);
+
+	SDL_UnlockMutex(loader.mutex);
+	loader_decode(job);
+	SDL_LockMutex(loader.mutex);
+
+	job->state = LOADER_JOB_STATE_DECODED;
+	SDL_CondBroadcast(loader.cond);
+}
+
+
+static int loader_thread(void *arg)
+{
+	SDL_LockMutex(loader.mutex);
+	for (;;) {
+		loader_job_t	*job;
+
+		while (!(job = loader_claim()))
+			SDL_CondWait(loader.cond, loader.mutex);
+
+		loader_run(job);
+	}
+
+	return 0;
+}
+
+
+/* claim the oldest decoded ANSR job for uploading, called with the lock held */
+static loader_job_t * loader_claim_upload(void)
+{
+	for (loader_job_t *job = loader.head; job; job = job->next) {
+		if (job->type == LOADER_JOB_TYPE_ANSR && job->state == LOADER_JOB_STATE_DECODED) {
+			job->state = LOADER_JOB_STATE_UPLOADING;
+
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+
+static int loader_upload_thread(void *arg)
+{
+	/* Prefer not binding the window's surface here at all, since EGL refuses
+	 * making a surface current on two threads.  Not every platform can do
+	 * surfaceless though, GLX is fine sharing the window.
+	 */
+	if (SDL_GL_MakeCurrent(NULL, loader.upload_gl) < 0 &&
+	    SDL_GL_MakeCurrent(loader.upload_window, loader.upload_gl) < 0) {
+		warn_if(1, "unable to make upload context current, uploading synchronously: %s", SDL_GetError());
+
+		SDL_LockMutex(loader.mutex);
+		loader.uploader = 0;
+		SDL_CondBroadcast(loader.cond);
+		SDL_UnlockMutex(loader.mutex);
+
+		return 0;
+	}
+
+	SDL_LockMutex(loader.mutex);
+	for (;;) {
+		loader_job_t	*job;
+
+		while (!(job = loader_claim_upload()))
+			SDL_CondWait(loader.cond, loader.mutex);
+
+		SDL_UnlockMutex(loader.mutex);
+		loader_upload(job);
+		SDL_LockMutex(loader.mutex);
+
+		job->state = LOADER_JOB_STATE_UPLOADED;
+		SDL_CondBroadcast(loader.cond);
+	}
+
+	return 0;
+}
+
+
+/* create the upload thread w/its own context sharing objects with the current
+ * one, which is left current when this returns.
+ */
+static void loader_init_uploader(SDL_Window *window)
+{
+	SDL_GLContext	gl = SDL_GL_GetCurrentContext();
+	SDL_Thread	*thread;
+
+	assert(gl);
+
+	if (SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1) < 0) {
+		warn_if(1, "unable to request shared GL context, uploading synchronously: %s", SDL_GetError());
+
+		return;
+	}
+
+	loader.upload_gl = SDL_GL_CreateContext(window);
+	(void) SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+	fatal_if(SDL_GL_MakeCurrent(window, gl) < 0, "unable to restore GL context: %s", SDL_GetError());
+
+	if (!loader.upload_gl) {
+		warn_if(1, "unable to create shared GL context, uploading synchronously: %s", SDL_GetError());
+
+		return;
+	}
+
+	loader.upload_window = window;
+	loader.uploader = 1;
+
+	thread = SDL_CreateThread(loader_upload_thread, "loader-upload", NULL);
+	if (!thread) {
+		warn_if(1, "unable to create upload thread, uploading synchronously: %s", SDL_GetError());
+		loader.uploader = 0;
+		SDL_GL_DeleteContext(loader.upload_gl);
+		loader.upload_gl = NULL;
+
+		return;
+	}
+
+	SDL_DetachThread(thread);
+}
+
+
+/* n_threads may be 0 for decoding cooperatively from loader_slice().
+ * upload_window may be NULL for doing all uploads from the GL thread,
+ * otherwise the window's GL context must be current.
+ */
+void loader_init(unsigned n_threads, SDL_Window *upload_window)
+{
+	assert(!loader.mutex);
+
+	loader.mutex = SDL_CreateMutex();
+	fatal_if(!loader.mutex, "unable to create loader mutex: %s", SDL_GetError());
+
+	loader.cond = SDL_CreateCond();
+	fatal_if(!loader.cond, "unable to create loader cond: %s", SDL_GetError());
+
+	for (unsigned i = 0; i < MIN(n_threads, LOADER_MAX_THREADS); i++) {
+		SDL_Thread	*thread;
+
+		thread = SDL_CreateThread(loader_thread, "loader", NULL);
+		warn_if(!thread, "unable to create loader thread: %s", SDL_GetError());
+		if (!thread)
+			break;
+
+		SDL_DetachThread(thread);
+		loader.n_threads++;
+	}
+
+	if (upload_window)
+		loader_init_uploader(upload_window);
+}
+
+
+static void loader_queue(loader_job_t *job)
+{
+	assert(loader.mutex);
+
+	SDL_LockMutex(loader.mutex);
+	if (loader.tail)
+		loader.tail->next = job;
+	else
+		loader.head = job;
+	loader.tail = job;
+	loader.n_pending++;
+	SDL_CondBroadcast(loader.cond);
+	SDL_UnlockMutex(loader.mutex);
+}
+
+
+static loader_job_t * loader_job_new_ansr(const char *path, const char *mask_path)
+{
+	loader_job_t	*job;
+
+	assert(path);
+
+	job = calloc(1, sizeof(loader_job_t));
+	fatal_if(!job, "unable to allocate loader job for \"%s\"", path);
+
+	job->type = LOADER_JOB_TYPE_ANSR;
+	job->path = path;
+	job->mask_path = mask_path;
+	ansr_tex_draw_size(path, mask_path, &job->draw_width, &job->draw_height);
+
+	return job;
+}
+
+
+/* queue path (+ mask_path if non-NULL) for decoding and uploading, the
+ * resulting tex_t is retrieved via ansr_tex_new(path, mask_path).
+ * The strings must remain valid for the life of the process.
+ */
+void loader_queue_ansr(const char *path, const char *mask_path)
+{
+	loader_queue(loader_job_new_ansr(path, mask_path));
+}
+
+
+/* queue path (+ mask_path if non-NULL) for decoding and uploading again at the
+ * lod the current canvas size calls for, the texture gets handed to
+ * ansr_tex_releveled() from loader_service().  The strings are copied.
+ */
+void loader_queue_relevel(const char *path, const char *mask_path)
+{
+	loader_job_t	*job;
+	char		*p, *m = NULL;
+
+	assert(path);
+
+	p = strdup(path);
+	fatal_if(!p, "unable to duplicate path \"%s\"", path);
+
+	if (mask_path) {
+		m = strdup(mask_path);
+		fatal_if(!m, "unable to duplicate mask path \"%s\"", mask_path);
+	}
+
+	job = loader_job_new_ansr(p, m);
+	job->relevel = 1;
+
+	loader_queue(job);
+}
+
+
+/* unlink and free the finished relevel jobs, called with the lock held */
+static void loader_reap(void)
+{
+	loader_job_t	**prev = &loader.head, *job, *last = NULL;
+
+	while ((job = *prev)) {
+		if (!job->relevel || job->state != LOADER_JOB_STATE_DONE) {
+			last = job;
+			prev = &job->next;
+			continue;
+		}
+
+		*prev = job->next;
+		free((char *)job->path);
+		free((char *)job->mask_path);
+		free(job);
+	}
+
+	loader.tail = last;
+}
+
+
+/* queue path for loading as a Mix_Chunk, which gets stored @ res_chunk from
+ * loader_service() once loaded.  *res_chunk stays untouched until then.
+ */
+void loader_queue_wav(const char *path, Mix_Chunk **res_chunk)
+{
+	loader_job_t	*job;
+
+	assert(path);
+	assert(res_chunk);
+
+	job = calloc(1, sizeof(loader_job_t));
+	fatal_if(!job, "unable to allocate loader job for \"%s\"", path);
+
+	job->type = LOADER_JOB_TYPE_WAV;
+	job->path = path;
+	job->res_chunk = res_chunk;
+
+	loader_queue(job);
+}
+
+
+/* finish any decoded jobs, must be called from the GL thread.
+ * returns the number of jobs still pending.
+ */
+unsigned loader_service(void)
+{
+	loader_job_t	*job;
+	unsigned	n_pending;
+
+	if (!loader.mutex)
+		return 0;
+
+	SDL_LockMutex(loader.mutex);
+	if (loader.n_pending)
+		loader.n_frames++;
+
+	for (job = loader.head; job; job = job->next) {
+		int	finished;
+
+		if (job->state == LOADER_JOB_STATE_DECODED) {
+			/* decoded sprites are the upload thread's when there is one */
+			if (job->type == LOADER_JOB_TYPE_ANSR && loader.uploader)
+				continue;
+
+			/* only this thread ever moves jobs out of DECODED, so it's safe to drop the lock here */
+			SDL_UnlockMutex(loader.mutex);
+			loader_finish(job);
+			SDL_LockMutex(loader.mutex);
+		} else if (job->state == LOADER_JOB_STATE_UPLOADED) {
+			/* the same goes for UPLOADED */
+			SDL_UnlockMutex(loader.mutex);
+			finished = loader_uploaded(job, 0);
+			if (finished)
+				loader_finish(job);
+			SDL_LockMutex(loader.mutex);
+
+			if (!finished)
+				continue;
+		} else {
+			continue;
+		}
+
+		job->state = LOADER_JOB_STATE_DONE;
+		loader.n_pending--;
+	}
+	loader_reap();
+	n_pending = loader.n_pending;
+	SDL_UnlockMutex(loader.mutex);
+
+	return n_pending;
+}
+
+
+/* advance the loader's work in steps until budget_us microseconds have passed,
+ * rasterizing up to n_rows glyph rows per step.  At least one step is always
+ * performed, and a budget_us of 0 finishes all the work.  Only does anything
+ * when there are no loader threads, must be called from the GL thread.
+ * Returns the number of jobs still pending.
+ */
+unsigned loader_slice(unsigned budget_us, unsigned n_rows)
+{
+	Uint64		start, budget;
+	unsigned	n_pending;
+
+	if (!loader.mutex)
+		return 0;
+
+	start = SDL_GetPerformanceCounter();
+	budget = (Uint64)budget_us * SDL_GetPerformanceFrequency() / 1000000;
+
+	SDL_LockMutex(loader.mutex);
+	while (!loader.n_threads) {
+		loader_job_t	*job = loader.slice_job;
+		int		finished;
+
+		if (!job) {
+			job = loader_claim();
+			if (!job)
+				break;
+
+			loader.slice_job = job;
+		}
+
+		SDL_UnlockMutex(loader.mutex);
+		finished = loader_step(job, n_rows);
+		SDL_LockMutex(loader.mutex);
+
+		if (finished) {
+			job->state = LOADER_JOB_STATE_DONE;
+			loader.n_pending--;
+			loader.slice_job = NULL;
+		}
+
+		if (budget_us && SDL_GetPerformanceCounter() - start >= budget)
+			break;
+	}
+	n_pending = loader.n_pending;
+	SDL_UnlockMutex(loader.mutex);
+
+	return n_pending;
+}
+
+
+/* returns the number of frames the loading has spanned so far */
+unsigned loader_frames(void)
+{
+	return loader.n_frames;
+}
+
+
+/* take the tex_t for a queued path + mask_path pair, waiting on or performing
+ * its decode if still outstanding, which gets indicated in *res_waited.
+ * The bounds of the sprite's opaque pixels are stored @ res_bounds.
+ * Each queued pair is only taken once, with the caller receiving the loader's
+ * reference.  Returns NULL when the pair wasn't queued or has already been
+ * taken.  Must be called from the GL thread.
+ */
+tex_t * loader_take_tex(const char *path, const char *mask_path, ansr_view_bounds_t *res_bounds, int *res_waited)
+{
+	loader_job_t	*job;
+	tex_t		*tex = NULL;
+
+	assert(path);
+
+	if (!loader.mutex)
+		return NULL;
+
+	SDL_LockMutex(loader.mutex);
+	for (job = loader.head; job; job = job->next) {
+		if (job->type == LOADER_JOB_TYPE_ANSR &&
+		    !job->relevel &&
+		    !job->taken &&
+		    STREQ(job->path, path) &&
+		    STREQ(job->mask_path, mask_path))
+			break;
+	}
+
+	if (!job) {
+		SDL_UnlockMutex(loader.mutex);
+
+		return NULL;
+	}
+
+	*res_waited = (job->state != LOADER_JOB_STATE_DONE);
+
+	if (!loader.n_threads && job->state != LOADER_JOB_STATE_DONE) {
+		/* cooperative mode, finish it here picking up wherever loader_slice() left off */
+		if (job == loader.slice_job)
+			loader.slice_job = NULL;
+
+		job->state = LOADER_JOB_STATE_RUNNING;
+		SDL_UnlockMutex(loader.mutex);
+		while (!loader_step(job, UINT_MAX));
+		SDL_LockMutex(loader.mutex);
+
+		job->state = LOADER_JOB_STATE_DONE;
+		loader.n_pending--;
+	}
+
+	if (job->state == LOADER_JOB_STATE_QUEUED) {
+		job->state = LOADER_JOB_STATE_RUNNING;
+		loader_run(job);
+	}
+
+	while (job->state == LOADER_JOB_STATE_RUNNING ||
+	       (loader.uploader && (job->state == LOADER_JOB_STATE_DECODED || job->state == LOADER_JOB_STATE_UPLOADING)))
+		SDL_CondWait(loader.cond, loader.mutex);
+
+	if (job->state == LOADER_JOB_STATE_DECODED || job->state == LOADER_JOB_STATE_UPLOADED) {
+		SDL_UnlockMutex(loader.mutex);
+		(void) loader_uploaded(job, 1);
+		loader_finish(job);
+		SDL_LockMutex(loader.mutex);
+
+		job->state = LOADER_JOB_STATE_DONE;
+		loader.n_pending--;
+	}
+
+	tex = job->tex;
+	*res_bounds = job->bounds;
+	job->tex = NULL;
+	job->taken = 1;
+	SDL_UnlockMutex(loader.mutex);
+
+	return tex;
+}
@@ -0,0 +1,35 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOADER_H
+#define _LOADER_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+typedef struct ansr_view_bounds_t ansr_view_bounds_t;
+typedef struct tex_t tex_t;
+
+void loader_init(unsigned n_threads, SDL_Window *upload_window);
+void loader_queue_ansr(const char *path, const char *mask_path);
+void loader_queue_relevel(const char *path, const char *mask_path);
+void loader_queue_wav(const char *path, Mix_Chunk **res_chunk);
+unsigned loader_service(void);
+unsigned loader_slice(unsigned budget_us, unsigned n_rows);
+unsigned loader_frames(void);
+tex_t * loader_take_tex(const char *path, const char *mask_path, ansr_view_bounds_t *res_bounds, int *res_waited);
+
+#endif
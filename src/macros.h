@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef SARS_DEBUG
 #define debugf(_fmt, ...) \
@@ -50,6 +51,10 @@
 #define CSTRLEN(_str) \
 	(sizeof(_str) - 1)
 
+/* like !strcmp(), but NULLs are only equal to each other */
+#define STREQ(_a, _b) \
+	((!(_a) || !(_b)) ? (_a) == (_b) : !strcmp((_a), (_b)))
+
 #ifndef MIN
 #define MIN(_a, _b) \
 	((_a) < (_b) ? (_a) : (_b))
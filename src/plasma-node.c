@@ -14,20 +14,50 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* The plasma is evaluated per pixel over the whole canvas, which gets costly
+ * on high-DPI canvases.  So it's rendered into a tex_target_t at a fraction
+ * of the viewport's resolution and upscaled from there w/bilinear filtering,
+ * which the smooth plasma tolerates well.
+ *
+ * When *lut is set the non-MAGA plasma is approximated w/a texture fetch
+ * instead, for weak GPUs.  The sum of sines v is precomputed once into a field
+ * texture, which gets zoomed and panned by the vertex shader.  Each channel's
+ * color is cos(PI * v + phase), so the field holds cos(PI * v) and sin(PI * v)
+ * and the colors are dot products of that w/a palette of per-channel phases
+ * cycling w/time and darkened by gloom, computed on the CPU per frame.  An 8
+ * bit v indexing a palette texture bands visibly, v spans four cycles of it.
+ * The sines' phases don't shift w/time across the field like the analytic
+ * version's, the palette's cycling makes up for it.
+ */
+
 #include <SDL.h>
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
 
 #include <play.h>
 #include <stage.h>
 
+#include "gl-state.h"
 #include "glad.h"
 #include "plasma-node.h"
 #include "shader-node.h"
 #include "macros.h"
 #include "m4f.h"
+#include "tex-target.h"
+
+#define PLASMA_LUT_FIELD_SIZE	256
+#define PLASMA_LUT_FIELD_EXTENT	8.f	/* the field spans -PLASMA_LUT_FIELD_EXTENT..+PLASMA_LUT_FIELD_EXTENT */
 
 typedef struct plasma_node_t {
-	unsigned	*maga;
 	float		*gloom;
+	unsigned	*maga;
+	const unsigned	*lut;
+	const float	*scale;
+	stage_t		*shader_node;	/* a discrete root stage rendered by us */
+	unsigned	shader_index;	/* plasma, MAGA or LUT plasma */
+	tex_target_t	*target;
+	unsigned	field;		/* LUT plasma texture, created on first use */
 } plasma_node_t;
 
 static const char	*plasma_vs = ""
@@ -196,48 +226,246 @@ static const char	*plasma_maga_fs = ""
 	"}"
 "";
 
-static void plasma_uniforms(void *uniforms_ctxt, void *render_ctxt, unsigned n_uniforms, const int *uniforms, const m4f_t *model_x, float alpha)
+/* the plasma's coordinates are zoomed and panned in the vertex shader, so the
+ * fragments just look up the field and color it.  See plasma_lut_field() for
+ * the field, which is plasma_fs' v w/o stime in the sines.
+ */
+static const char	*plasma_lut_vs = ""
+#ifdef __EMSCRIPTEN__
+	"#version 100\n"
+
+	"varying vec2 UV;"
+#else
+	"#version 120\n"
+#endif
+
+	"uniform mat4	projection_x;"
+	"uniform float	time;"
+
+	"attribute vec3 vertex;"
+	"attribute vec2 texcoord;"
+
+	"void main()"
+	"{"
+	"	float stime = sin(time * .01) * 100.0;"
+	"	vec2 c = texcoord;"
+
+	"	c *= (sin(stime * .01) *.5 + .5) * 3.0 + 1.0;"
+	"	c += vec2(sin(stime * .33), cos(stime * .5)) * 3.0;"
+	"	c = c * (.5 / 8.0) + .5;"	/* PLASMA_LUT_FIELD_EXTENT */
+#ifdef __EMSCRIPTEN__
+	"	UV = c;"
+#else
+	"	gl_TexCoord[0].xy = c;"
+#endif
+	"	gl_Position = projection_x * vec4(vertex, 1.0);"
+	"}"
+"";
+
+
+static const char	*plasma_lut_fs = ""
+#ifdef __EMSCRIPTEN__
+	"#version 100\n"
+
+	"precision mediump float;"
+	"varying vec2 UV;"
+#else
+	"#version 120\n"
+#endif
+
+	"uniform float	alpha;"
+	"uniform sampler2D	field;"
+	"uniform vec3	palette_cos;"	/* see plasma_lut_uniforms() */
+	"uniform vec3	palette_sin;"
+	"uniform vec3	palette_base;"
+
+	"void main() {"
+#ifdef __EMSCRIPTEN__
+	"	vec2 f = texture2D(field, UV).ra * 2. - 1.;"
+#else
+	"	vec2 f = texture2D(field, gl_TexCoord[0].st).ra * 2. - 1.;"
+#endif
+	"	gl_FragColor = vec4(f.x * palette_cos + f.y * palette_sin + palette_base, alpha);"
+	"}"
+"";
+
+
+static void plasma_uniforms(void *uniforms_ctxt, void *render_ctxt, unsigned n_uniforms, const int *uniforms, const m4f_t *model_x, unsigned model_version, float alpha)
 {
 	plasma_node_t	*plasma = uniforms_ctxt;
 	play_t		*play = render_ctxt;
 
 	glUniform1f(uniforms[0], alpha);
 	glUniform1f(uniforms[1], play_ticks(play, PLAY_TICKS_TIMER0) * .001f); // FIXME KLUDGE ALERT
-	glUniformMatrix4fv(uniforms[2], 1, GL_FALSE, &model_x->m[0][0]);
+	gl_state_uniform_m4f(uniforms[2], model_x, model_version);
 	glUniform1f(uniforms[3], *(plasma->gloom));
 }
 
 
-/* create plasma rendering stage */
-stage_t * plasma_node_new(const stage_conf_t *conf, m4f_t *projection_x, float *gloom, unsigned *maga)
+/* precompute plasma_fs' sum of sines v over the field w/o the time, as
+ * cos(PI * v) and sin(PI * v).
+ */
+static unsigned plasma_lut_field(void)
+{
+	static unsigned char	field[PLASMA_LUT_FIELD_SIZE * PLASMA_LUT_FIELD_SIZE * 2];
+	unsigned		name;
+
+	for (int y = 0; y < PLASMA_LUT_FIELD_SIZE; y++) {
+		float	cy = ((y + .5f) * (2.f / PLASMA_LUT_FIELD_SIZE) - 1.f) * PLASMA_LUT_FIELD_EXTENT;
+
+		for (int x = 0; x < PLASMA_LUT_FIELD_SIZE; x++) {
+			float	cx = ((x + .5f) * (2.f / PLASMA_LUT_FIELD_SIZE) - 1.f) * PLASMA_LUT_FIELD_EXTENT;
+			float	v;
+
+			v = sinf(cx);
+			v += sinf(cy * .5f);
+			v += sinf((cx + cy) * .5f);
+			v += sinf(sqrtf(cx * cx + cy * cy + 1.f));
+
+			field[(y * PLASMA_LUT_FIELD_SIZE + x) * 2 + 0] = (cosf((float)M_PI * v) + 1.f) * 127.5f + .5f;
+			field[(y * PLASMA_LUT_FIELD_SIZE + x) * 2 + 1] = (sinf((float)M_PI * v) + 1.f) * 127.5f + .5f;
+		}
+	}
+
+	glGenTextures(1, &name);
+	gl_state_bind_texture(0, name);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, PLASMA_LUT_FIELD_SIZE, PLASMA_LUT_FIELD_SIZE, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, field);
+
+	return name;
+}
+
+
+/* plasma_fs colors v w/(cos(PI * v + phase) * .5 + .5) * (1 - gloom) per
+ * channel, green's sin() being a cos() a quarter turn behind.  Expanding the
+ * cos() of the sum turns that into f.x * palette_cos + f.y * palette_sin +
+ * palette_base for the field's f = (cos(PI * v), sin(PI * v)).  stime is added
+ * to the phases standing in for the field's own movement.
+ */
+static void plasma_lut_uniforms(void *uniforms_ctxt, void *render_ctxt, unsigned n_uniforms, const int *uniforms, const m4f_t *model_x, unsigned model_version, float alpha)
+{
+	plasma_node_t	*plasma = uniforms_ctxt;
+	play_t		*play = render_ctxt;
+	float		time = play_ticks(play, PLAY_TICKS_TIMER0) * .001f; // FIXME KLUDGE ALERT
+	float		stime = sinf(time * .01f) * 100.f;
+	float		shade = (1.f - *(plasma->gloom)) * .5f;
+	float		phases[3] = {
+				stime + sinf(time),
+				stime + cosf(time * .33f) - (float)M_PI * .5f,
+				stime + sinf(time * .66f),
+			};
+	float		cos_phases[3], sin_phases[3];
+
+	if (!plasma->field)
+		plasma->field = plasma_lut_field();
+
+	for (int i = 0; i < 3; i++) {
+		cos_phases[i] = cosf(phases[i]) * shade;
+		sin_phases[i] = -sinf(phases[i]) * shade;
+	}
+
+	gl_state_bind_texture(0, plasma->field);
+
+	glUniform1f(uniforms[0], alpha);
+	glUniform1f(uniforms[1], time);
+	gl_state_uniform_m4f(uniforms[2], model_x, model_version);
+	glUniform1i(uniforms[3], 0);
+	glUniform3fv(uniforms[4], 1, cos_phases);
+	glUniform3fv(uniforms[5], 1, sin_phases);
+	glUniform3f(uniforms[6], shade, shade, shade);
+}
+
+
+static stage_render_func_ret_t plasma_node_render(const stage_t *stage, void *object, float alpha, void *render_ctxt)
+{
+	plasma_node_t	*plasma = object;
+	float		scale = plasma->scale ? *(plasma->scale) : 1.f;
+
+	assert(stage);
+	assert(plasma);
+
+	if (*(plasma->maga))
+		plasma->shader_index = 1;
+	else
+		plasma->shader_index = (plasma->lut && *(plasma->lut)) ? 2 : 0;
+
+	if (scale >= 1.f) {
+		stage_set_alpha(plasma->shader_node, alpha);
+		stage_dirty(plasma->shader_node);
+		(void) stage_render(plasma->shader_node, render_ctxt);
+
+		return STAGE_RENDER_FUNC_RET_CONTINUE;
+	}
+
+	(void) tex_target_fit(plasma->target, scale);
+	tex_target_begin(plasma->target);
+	stage_set_alpha(plasma->shader_node, 1.f);
+	stage_dirty(plasma->shader_node);
+	(void) stage_render(plasma->shader_node, render_ctxt);
+	tex_target_end(plasma->target);
+
+	tex_target_render(plasma->target, alpha);
+
+	return STAGE_RENDER_FUNC_RET_CONTINUE;
+}
+
+
+static void plasma_node_free(const stage_t *stage, void *object)
+{
+	plasma_node_t	*plasma = object;
+
+	assert(stage);
+	assert(plasma);
+
+	stage_free(plasma->shader_node);
+	tex_target_free(plasma->target);
+
+	if (plasma->field)
+		gl_state_delete_texture(plasma->field);
+
+	free(plasma);
+}
+
+
+static const stage_ops_t plasma_node_ops = {
+	.render_func = plasma_node_render,
+	.free_func = plasma_node_free,
+};
+
+
+/* create plasma rendering stage, rendered at *scale of the viewport's
+ * resolution when scale is non-NULL and *scale < 1.  When lut is non-NULL
+ * and *lut is set, the non-MAGA plasma is rendered from lookup textures.
+ */
+stage_t * plasma_node_new(const stage_conf_t *conf, m4f_t *projection_x, unsigned *projection_version, float *gloom, unsigned *maga, const float *scale, const unsigned *lut)
 {
-	plasma_node_t	*ctxt;
-
-	/* FIXME TODO:
-	 * shader-node doesn't cleanup uniforms_ctxt, so this is being leaked currently.
-	 * but that doesn't really matter since plasma-node is only created once per game.
-	 * The shortest path to cleaning this up would be to publicize the shader-node struct
-	 * and implementation functions, and stitch it all together here, maybe with a nested
-	 * shader_node_t in plasma_node_t.  That's rather annoying, and perhaps highlights a
-	 * shortcoming in the existing stage_t composability.  It'd be nice if uniforms_ctxt
-	 * could be typed with something embedding an optional free func, which shader_node_free()
-	 * would then call to cleanup when set.  It's unclear if that should just be a bespoke
-	 * shader-node type, or something more generally defined by libstage.  Either way, it's
-	 * not terribly important for SARS in this singleton plasma-node case.
-	 */
-	ctxt = calloc(1, sizeof(plasma_node_t));
-	fatal_if(!ctxt, "unable to allocate plasma_node_t");
-
-	ctxt->gloom = gloom;
-
-	return	shader_node_new_srcv(conf, 2,
+	plasma_node_t	*plasma;
+	stage_t		*s;
+
+	plasma = calloc(1, sizeof(plasma_node_t));
+	fatal_if(!plasma, "unable to allocate plasma_node_t");
+
+	plasma->gloom = gloom;
+	plasma->maga = maga;
+	plasma->lut = lut;
+	plasma->scale = scale;
+	plasma->target = tex_target_new();
+
+	s = stage_new(conf, &plasma_node_ops, plasma);
+	fatal_if(!s, "Unable to create stage \"%s\"", conf->name);
+
+	plasma->shader_node = shader_node_new_srcv(&(stage_conf_t){ .name = "plasma-shader", .active = 1, .alpha = 1.f }, 3,
 			(shader_src_conf_t[]){
 				{
 					.vs_src = plasma_vs,
 					.fs_src = plasma_fs,
 					.transform = projection_x,
+					.transform_version = projection_version,
 					.uniforms_func = plasma_uniforms,
-					.uniforms_ctxt = ctxt,
+					.uniforms_ctxt = plasma,
 					.n_uniforms = 4,
 					.uniforms = (const char *[]){
 						"alpha",
@@ -249,8 +477,9 @@ stage_t * plasma_node_new(const stage_conf_t *conf, m4f_t *projection_x, float *
 					.vs_src = plasma_vs,
 					.fs_src = plasma_maga_fs,
 					.transform = projection_x,
+					.transform_version = projection_version,
 					.uniforms_func = plasma_uniforms,
-					.uniforms_ctxt = ctxt,
+					.uniforms_ctxt = plasma,
 					.n_uniforms = 4,
 					.uniforms = (const char *[]){
 						"alpha",
@@ -258,8 +487,27 @@ stage_t * plasma_node_new(const stage_conf_t *conf, m4f_t *projection_x, float *
 						"projection_x",
 						"gloom",
 					},
+				}, {
+					.vs_src = plasma_lut_vs,
+					.fs_src = plasma_lut_fs,
+					.transform = projection_x,
+					.transform_version = projection_version,
+					.uniforms_func = plasma_lut_uniforms,
+					.uniforms_ctxt = plasma,
+					.n_uniforms = 7,
+					.uniforms = (const char *[]){
+						"alpha",
+						"time",
+						"projection_x",
+						"field",
+						"palette_cos",
+						"palette_sin",
+						"palette_base",
+					},
 				},
 			},
-			maga
+			&plasma->shader_index
 		);
+
+	return s;
 }
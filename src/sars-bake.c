@@ -0,0 +1,580 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* sars-bake is a build-time tool for turning assets/foo.ans (+ foo.mask.ans
+ * when present) into assets/foo.bake, see bake.c.
+ *
+ * usage: sars-bake [--bench [ITERATIONS] | --embed OUTPUT.c] FILE.ans...
+ *        sars-bake --cp437-bits OUTPUT.h
+ *
+ * Any .mask.ans files in FILE.ans... are skipped, as they're picked up
+ * alongside their image counterpart, so just passing every .ans found under
+ * assets/ does the right thing.
+ *
+ * With --bench nothing gets written (beyond baking anything not yet baked),
+ * instead the per-asset decode throughput of the runtime slow path vs. the
+ * baked path is measured and reported.  The slow path is measured with the
+ * original rasterizer ("reference"), the bit-packed one ("bits"), and the
+ * default which adds the tile cache ("tiles"), all of which must produce
+ * identical output.  The tile cache's hit rate is reported per asset.
+ * The cell grids used by sars --cell-textures get checked against the same
+ * output, expanded the way tex.c's shader does it, and their size compared
+ * to the rasterized pixels in the totals.  Collision masks get built from
+ * each asset too, with their overlap test timed across random placements
+ * overlapping the asset's own mask and checked against testing every cell.
+ *
+ * With --embed no .bake files are written, instead OUTPUT.c is generated
+ * containing every asset for compiling into the executable, see embed.c.
+ *
+ * With --cp437-bits the bit-packed font in cp437-bits.h is regenerated from
+ * cp437.h's image instead, see `make cp437-bits`.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ansr-view.h"
+#include "bake.h"
+#include "bitmask.h"
+#include "cp437.h"
+#include "cp437-bits.h"
+#include "embed.h"
+#include "macros.h"
+
+#define SARS_BAKE_DEFAULT_ITERATIONS	20
+#define SARS_BAKE_BITMASK_WIDTH		96	/* wider than a word, like the TV's in-game */
+#define SARS_BAKE_BITMASK_TESTS		10000	/* per iteration */
+
+static struct {
+	double		mpix, reference_ms, bits_ms, slow_ms, baked_ms, cells_ms, bitmask_ns;
+	unsigned	tile_hits, tile_misses, n_assets;
+	size_t		cells_bytes, pixels_bytes;
+} bench_totals;
+
+
+static int is_mask_path(const char *path)
+{
+	size_t	len = strlen(path);
+
+	return len >= CSTRLEN(".mask.ans") && !strcmp(&path[len - CSTRLEN(".mask.ans")], ".mask.ans");
+}
+
+
+/* "foo.ans" -> "foo.mask.ans" if it exists, NULL otherwise, caller must free() the result */
+static char * mask_path_for(const char *path)
+{
+	size_t	len = strlen(path);
+	char	*res;
+
+	if (len < CSTRLEN(".ans") || strcmp(&path[len - CSTRLEN(".ans")], ".ans"))
+		return NULL;
+
+	len -= CSTRLEN(".ans");
+	res = malloc(len + sizeof(".mask.ans"));
+	fatal_if(!res, "unable to allocate mask path for \"%s\"", path);
+
+	memcpy(res, path, len);
+	memcpy(&res[len], ".mask.ans", sizeof(".mask.ans"));
+
+	if (access(res, R_OK) < 0) {
+		free(res);
+
+		return NULL;
+	}
+
+	return res;
+}
+
+
+static double now_ms(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * .000001;
+}
+
+
+static void bake(const char *path, const char *mask_path, const char *baked_path)
+{
+	ansr_view_t	*v;
+	int		r;
+
+	v = ansr_view_new(path, mask_path);
+	r = bake_write(baked_path, v);
+	fatal_if(r < 0, "unable to write \"%s\": %s", baked_path, strerror(-r));
+
+	printf("%s: %ux%u%s -> %s\n", path, v->width, v->height, mask_path ? " (masked)" : "", baked_path);
+	ansr_view_free(v);
+}
+
+
+/* time iterations of ansr_view_new(), returns the average ms per view */
+static double bench_rasterize(const char *path, const char *mask_path, unsigned iterations, uint32_t *sum)
+{
+	double	start = now_ms();
+
+	for (unsigned i = 0; i < iterations; i++) {
+		ansr_view_t	*v;
+
+		v = ansr_view_new(path, mask_path);
+		*sum += v->pixels[i % (v->width * v->height)];
+		ansr_view_free(v);
+	}
+
+	return (now_ms() - start) / iterations;
+}
+
+
+/* rasterize path + mask_path with rasterizer, timing iterations of it and
+ * checking the output matches reference (when non-NULL).
+ */
+static double bench_rasterizer(const char *path, const char *mask_path, ansr_view_rasterizer_t rasterizer, unsigned iterations, const ansr_view_t *reference, uint32_t *sum)
+{
+	ansr_view_t	*v;
+	double		ms;
+
+	ansr_view_set_rasterizer(rasterizer);
+	v = ansr_view_new(path, mask_path);
+	ms = bench_rasterize(path, mask_path, iterations, sum);
+	ansr_view_set_rasterizer(ANSR_VIEW_RASTERIZER_TILES);
+
+	fatal_if(reference &&
+		 (v->width != reference->width || v->height != reference->height ||
+		  memcmp(v->pixels, reference->pixels, v->width * v->height * sizeof(uint32_t))),
+		"\"%s\" rasterized differently than the reference", path);
+	ansr_view_free(v);
+
+	return ms;
+}
+
+
+/* expand cells to pixels like the fragment shader in tex.c does */
+static ansr_view_t * cells_view(const ansr_cells_t *cells)
+{
+	ansr_view_t	*v;
+
+	v = calloc(1, sizeof(ansr_view_t) + cells->width * 8 * cells->height * 16 * sizeof(uint32_t));
+	fatal_if(!v, "unable to allocate view for cells");
+
+	v->width = cells->width * 8;
+	v->height = cells->height * 16;
+
+	for (unsigned r = 0; r < cells->height; r++) {
+		for (unsigned c = 0; c < cells->width; c++) {
+			uint32_t	cell = cells->cells[r * cells->width + c];
+			unsigned	code = cell & 0xff, fg = (cell >> 8) & 0xf, bg = (cell >> 12) & 0xf;
+			unsigned	cover_code = (cell >> 16) & 0xff, cover_flags = cell >> 24;
+
+			for (unsigned y = 0; y < 16; y++) {
+				uint32_t	*dest = &v->pixels[(r * 16 + y) * v->width + c * 8];
+
+				for (unsigned x = 0; x < 8; x++) {
+					unsigned	bit = 0x80 >> x;
+
+					if (!(cover_flags & ((cp437_bits[cover_code][y] & bit) ? ANSR_CELLS_COVER_FG : ANSR_CELLS_COVER_BG)))
+						continue;
+
+					dest[x] = ansr_view_palette[(cp437_bits[code][y] & bit) ? fg : bg];
+				}
+			}
+		}
+	}
+
+	return v;
+}
+
+
+/* bitmask_overlaps() the slow way, cell by cell */
+static int bitmask_overlaps_reference(const bitmask_t *a, int ax, int ay, const bitmask_t *b, int bx, int by)
+{
+	for (int y = 0; y < (int)a->height; y++) {
+		for (int x = 0; x < (int)a->width; x++) {
+			int	x2 = ax + x - bx, y2 = ay + y - by;
+
+			if (!(a->rows[y * a->stride + x / 64] & (1ull << (x & 63))))
+				continue;
+
+			if (x2 < 0 || y2 < 0 || x2 >= (int)b->width || y2 >= (int)b->height)
+				continue;
+
+			if (b->rows[y2 * b->stride + x2 / 64] & (1ull << (x2 & 63)))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/* time bitmask_overlaps() of v's mask against itself placed randomly within
+ * its AABB, returns the average ns per test, the mask's height and the hit
+ * rate in *res_height and *res_hits.
+ */
+static double bench_bitmask(const char *path, const ansr_view_t *v, unsigned iterations, unsigned *res_height, double *res_hits, uint32_t *sum)
+{
+	unsigned	w = SARS_BAKE_BITMASK_WIDTH, h = MAX(SARS_BAKE_BITMASK_WIDTH * v->height / v->width, 1);
+	int		offsets[SARS_BAKE_BITMASK_TESTS][2];
+	unsigned	hits = 0;
+	bitmask_t	*mask;
+	double		start;
+
+	mask = bitmask_new(v->width, v->height, v->pixels, w, h);
+
+	srand(0);
+	for (unsigned i = 0; i < NELEMS(offsets); i++) {
+		offsets[i][0] = rand() % (2 * w - 1) - (int)w + 1;
+		offsets[i][1] = rand() % (2 * h - 1) - (int)h + 1;
+
+		fatal_if(bitmask_overlaps(mask, 0, 0, mask, offsets[i][0], offsets[i][1]) !=
+			 bitmask_overlaps_reference(mask, 0, 0, mask, offsets[i][0], offsets[i][1]),
+			"\"%s\" bitmask overlap at %i,%i differs from the reference", path, offsets[i][0], offsets[i][1]);
+	}
+
+	start = now_ms();
+	for (unsigned i = 0; i < iterations; i++) {
+		for (unsigned j = 0; j < NELEMS(offsets); j++)
+			hits += bitmask_overlaps(mask, 0, 0, mask, offsets[j][0], offsets[j][1]);
+	}
+	*sum += hits;
+	*res_height = h;
+	*res_hits = (double)hits / ((double)iterations * NELEMS(offsets));
+
+	bitmask_free(mask);
+
+	return (now_ms() - start) * 1000000.0 / ((double)iterations * NELEMS(offsets));
+}
+
+
+static void bench(const char *path, const char *mask_path, const char *baked_path, unsigned iterations)
+{
+	double			start, reference_ms, bits_ms, slow_ms, baked_ms, cells_ms, bitmask_ns, bitmask_hits, mpix;
+	ansr_view_t		*reference, *v;
+	ansr_cells_t		*cells;
+	ansr_view_job_t		*job;
+	ansr_view_stats_t	stats;
+	unsigned		bitmask_height;
+	uint32_t		sum = 0;
+	bake_t			*b;
+
+	b = bake_map(baked_path, path, mask_path);
+	if (!b) {
+		bake(path, mask_path, baked_path);
+		b = bake_map(baked_path, path, mask_path);
+		fatal_if(!b, "unable to map freshly baked \"%s\"", baked_path);
+	}
+	mpix = (double)b->width * b->height * .000001;
+	b = bake_unmap(b);
+
+	ansr_view_set_rasterizer(ANSR_VIEW_RASTERIZER_REFERENCE);
+	reference = ansr_view_new(path, mask_path);
+	reference_ms = bench_rasterizer(path, mask_path, ANSR_VIEW_RASTERIZER_REFERENCE, iterations, NULL, &sum);
+	bits_ms = bench_rasterizer(path, mask_path, ANSR_VIEW_RASTERIZER_BITS, iterations, reference, &sum);
+	slow_ms = bench_rasterizer(path, mask_path, ANSR_VIEW_RASTERIZER_TILES, iterations, reference, &sum);
+
+	start = now_ms();
+	for (unsigned i = 0; i < iterations; i++) {
+		cells = ansr_cells_new(path, mask_path);
+		sum += cells->cells[i % (cells->width * cells->height)];
+		ansr_cells_free(cells);
+	}
+	cells_ms = (now_ms() - start) / iterations;
+
+	cells = ansr_cells_new(path, mask_path);
+	v = cells_view(cells);
+	fatal_if(v->width != reference->width || v->height != reference->height ||
+		 memcmp(v->pixels, reference->pixels, v->width * v->height * sizeof(uint32_t)),
+		"\"%s\" cells expand differently than the reference", path);
+	bench_totals.cells_bytes += cells->width * cells->height * sizeof(uint32_t);
+	bench_totals.pixels_bytes += v->width * v->height * sizeof(uint32_t);
+	ansr_view_free(v);
+	ansr_cells_free(cells);
+
+	bitmask_ns = bench_bitmask(path, reference, iterations, &bitmask_height, &bitmask_hits, &sum);
+	ansr_view_free(reference);
+
+	job = ansr_view_job_new(path, mask_path);
+	while (!ansr_view_job_step(job, UINT_MAX));
+	ansr_view_free(ansr_view_job_finish(job, &stats));
+
+	/* touch every pixel of the mapping, otherwise this is just timing mmap() */
+	start = now_ms();
+	for (unsigned i = 0; i < iterations; i++) {
+		b = bake_map(baked_path, path, mask_path);
+		for (size_t j = 0; j < b->width * b->height; j++)
+			sum += b->pixels[j];
+		b = bake_unmap(b);
+	}
+	baked_ms = (now_ms() - start) / iterations;
+
+	printf("%-28s %6.3f Mpix  reference %7.3fms (%6.1f Mpix/s)  bits %7.3fms (%6.1f Mpix/s)  tiles %7.3fms (%6.1f Mpix/s, %5.1f%% hits)  baked %7.3fms (%6.1f Mpix/s)  %5.1fx  [%08x]\n",
+		path, mpix,
+		reference_ms, mpix / reference_ms * 1000.0,
+		bits_ms, mpix / bits_ms * 1000.0,
+		slow_ms, mpix / slow_ms * 1000.0, 100.0 * stats.tile_hits / MAX(stats.tile_hits + stats.tile_misses, 1),
+		baked_ms, mpix / baked_ms * 1000.0,
+		slow_ms / baked_ms,
+		sum);
+	printf("%-28s bitmask %ux%u overlaps %6.1fns (%5.1f%% hits)\n",
+		"", SARS_BAKE_BITMASK_WIDTH, bitmask_height, bitmask_ns, bitmask_hits * 100.0);
+
+	bench_totals.mpix += mpix;
+	bench_totals.reference_ms += reference_ms;
+	bench_totals.bits_ms += bits_ms;
+	bench_totals.slow_ms += slow_ms;
+	bench_totals.baked_ms += baked_ms;
+	bench_totals.cells_ms += cells_ms;
+	bench_totals.bitmask_ns += bitmask_ns;
+	bench_totals.n_assets++;
+	bench_totals.tile_hits += stats.tile_hits;
+	bench_totals.tile_misses += stats.tile_misses;
+}
+
+
+/* "some/dir/foo.ans" -> "assets/foo.ans", the path the game asks for at runtime */
+static void fprint_asset_path(FILE *out, const char *path)
+{
+	const char	*base = strrchr(path, '/');
+
+	fprintf(out, "\"assets/%s\"", base ? base + 1 : path);
+}
+
+
+static unsigned char palette_index(const char *path, uint32_t pixel)
+{
+	if (!(pixel & 0xff000000))
+		return EMBED_TRANSPARENT;
+
+	for (unsigned char i = 0; i < NELEMS(ansr_view_palette); i++) {
+		if (ansr_view_palette[i] == pixel)
+			return i;
+	}
+
+	fatal_if(1, "\"%s\" pixel %08x isn't in the palette", path, pixel);
+}
+
+
+/* emit the rle-encoded palette indices and the cells for asset n, see embed.c */
+static void embed(FILE *out, unsigned n, const char *path, const char *mask_path, unsigned *res_width, unsigned *res_height, unsigned *res_cells_width, unsigned *res_cells_height)
+{
+	size_t		n_pixels, rle_len = 0;
+	ansr_cells_t	*cells;
+	ansr_view_t	*v;
+
+	v = ansr_view_new(path, mask_path);
+	*res_width = v->width;
+	*res_height = v->height;
+	n_pixels = v->width * v->height;
+
+	fprintf(out, "/* %s */\nstatic const unsigned char asset_%u_rle[] = {", path, n);
+	for (size_t i = 0; i < n_pixels;) {
+		unsigned char	idx = palette_index(path, v->pixels[i]);
+		unsigned	len = 1;
+
+		while (i + len < n_pixels && len < 256 && palette_index(path, v->pixels[i + len]) == idx)
+			len++;
+
+		fprintf(out, "%s%u,%u,", (rle_len % 16) ? " " : "\n\t", len - 1, idx);
+		rle_len += 2;
+		i += len;
+	}
+	fprintf(out, "\n};\n\n");
+
+	cells = ansr_cells_new(path, mask_path);
+	*res_cells_width = cells->width;
+	*res_cells_height = cells->height;
+
+	fprintf(out, "static const uint32_t asset_%u_cells[] = {", n);
+	for (size_t i = 0; i < cells->width * cells->height; i++)
+		fprintf(out, "%s0x%08x,", (i % 8) ? " " : "\n\t", cells->cells[i]);
+	fprintf(out, "\n};\n\n");
+
+	fprintf(stderr, "%s: %ux%u%s -> %zu bytes embedded\n", path, v->width, v->height, mask_path ? " (masked)" : "",
+		rle_len + cells->width * cells->height * sizeof(uint32_t));
+	ansr_cells_free(cells);
+	ansr_view_free(v);
+}
+
+
+static void embed_all(const char *out_path, int argc, char *argv[])
+{
+	struct {
+		const char	*path;
+		char		*mask_path;
+		unsigned	width, height;
+		unsigned	cells_width, cells_height;
+	}		assets[argc];
+	unsigned	n_assets = 0;
+	char		*tmp_path;
+	FILE		*out;
+
+	/* write to a temporary and rename so an interrupted build doesn't leave a partial output behind */
+	tmp_path = malloc(strlen(out_path) + sizeof(".tmp"));
+	fatal_if(!tmp_path, "unable to allocate temporary path for \"%s\"", out_path);
+	strcpy(tmp_path, out_path);
+	strcat(tmp_path, ".tmp");
+
+	out = fopen(tmp_path, "w");
+	fatal_if(!out, "unable to open \"%s\"", tmp_path);
+
+	fprintf(out, "/* generated by sars-bake --embed, do not edit */\n\n#include \"embed.h\"\n\n");
+
+	for (int i = 0; i < argc; i++) {
+		if (is_mask_path(argv[i]))
+			continue;
+
+		assets[n_assets].path = argv[i];
+		assets[n_assets].mask_path = mask_path_for(argv[i]);
+		embed(out, n_assets, assets[n_assets].path, assets[n_assets].mask_path,
+		      &assets[n_assets].width, &assets[n_assets].height,
+		      &assets[n_assets].cells_width, &assets[n_assets].cells_height);
+		n_assets++;
+	}
+
+	fprintf(out, "const embed_asset_t embed_assets[] = {\n");
+	for (unsigned i = 0; i < n_assets; i++) {
+		fprintf(out, "\t{\n\t\t.path = ");
+		fprint_asset_path(out, assets[i].path);
+		fprintf(out, ",\n\t\t.mask_path = ");
+		if (assets[i].mask_path)
+			fprint_asset_path(out, assets[i].mask_path);
+		else
+			fprintf(out, "NULL");
+		fprintf(out, ",\n\t\t.width = %u,\n\t\t.height = %u,\n", assets[i].width, assets[i].height);
+		fprintf(out, "\t\t.rle = asset_%u_rle,\n\t\t.rle_len = sizeof(asset_%u_rle),\n", i, i);
+		fprintf(out, "\t\t.cells_width = %u,\n\t\t.cells_height = %u,\n", assets[i].cells_width, assets[i].cells_height);
+		fprintf(out, "\t\t.cells = asset_%u_cells,\n\t},\n", i);
+
+		free(assets[i].mask_path);
+	}
+	fprintf(out, "};\n\nconst unsigned embed_n_assets = %u;\n", n_assets);
+
+	fatal_if(fclose(out) != 0, "unable to write \"%s\"", tmp_path);
+	fatal_if(rename(tmp_path, out_path) < 0, "unable to rename \"%s\" to \"%s\"", tmp_path, out_path);
+	free(tmp_path);
+}
+
+
+/* write cp437-bits.h, cp437.h's glyphs packed a byte per row w/bit 7 leftmost.
+ * The image lays them out in 32 columns of 9x16 cells w/8 pixels of padding
+ * all around, the 9th column being the divider which is dropped.
+ */
+static void cp437_bits_write(const char *out_path)
+{
+	FILE	*out;
+
+	out = fopen(out_path, "w");
+	fatal_if(!out, "unable to open \"%s\"", out_path);
+
+	fprintf(out, "/* generated from cp437.h by `make cp437-bits`, do not edit\n"
+		     " *\n"
+		     " * The 8x16 cp437 glyphs bit-packed one byte per row, with bit 7 as the\n"
+		     " * leftmost pixel.  Indexed as cp437_bits[glyph][row].\n"
+		     " */\n\n"
+		     "static const unsigned char\tcp437_bits[256][16] = {\n");
+
+	for (int c = 0; c < 256; c++) {
+		const unsigned char	*src = &cp437.pixel_data[(8 + (c / 32) * 16) * cp437.width + (8 + (c % 32) * 9)];
+
+		fprintf(out, "\t{");
+		for (int v = 0; v < 16; v++) {
+			unsigned char	bits = 0;
+
+			for (int u = 0; u < 8; u++) {
+				if (src[v * cp437.width + u])
+					bits |= 0x80 >> u;
+			}
+			fprintf(out, "%s 0x%02x", v ? "," : "", bits);
+		}
+		fprintf(out, " },\t/* 0x%02x */\n", c);
+	}
+	fprintf(out, "};\n");
+
+	fatal_if(fclose(out) != 0, "unable to write \"%s\"", out_path);
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned	iterations = 0;
+	int		i = 1;
+
+	if (i < argc && !strcmp(argv[i], "--bench")) {
+		iterations = SARS_BAKE_DEFAULT_ITERATIONS;
+		i++;
+
+		if (i < argc && argv[i][0] >= '1' && argv[i][0] <= '9')
+			iterations = strtoul(argv[i++], NULL, 10);
+	} else if (i + 1 < argc && !strcmp(argv[i], "--embed")) {
+		/* embed_all() sizes a VLA by the number of files */
+		fatal_if(i + 2 >= argc, "nothing to embed in \"%s\"", argv[i + 1]);
+		embed_all(argv[i + 1], argc - (i + 2), &argv[i + 2]);
+
+		return EXIT_SUCCESS;
+	} else if (i + 1 < argc && !strcmp(argv[i], "--cp437-bits")) {
+		cp437_bits_write(argv[i + 1]);
+
+		return EXIT_SUCCESS;
+	}
+
+	if (i >= argc) {
+		fprintf(stderr, "usage: %s [--bench [ITERATIONS] | --embed OUTPUT.c] FILE.ans...\n"
+				"       %s --cp437-bits OUTPUT.h\n", argv[0], argv[0]);
+
+		return EXIT_FAILURE;
+	}
+
+	for (; i < argc; i++) {
+		char	*mask_path, *baked_path;
+
+		if (is_mask_path(argv[i]))
+			continue;
+
+		mask_path = mask_path_for(argv[i]);
+		baked_path = bake_path(argv[i]);
+		fatal_if(!baked_path, "unable to allocate baked path for \"%s\"", argv[i]);
+
+		if (iterations)
+			bench(argv[i], mask_path, baked_path, iterations);
+		else
+			bake(argv[i], mask_path, baked_path);
+
+		free(baked_path);
+		free(mask_path);
+	}
+
+	if (iterations && bench_totals.mpix) {
+		printf("%-28s %6.3f Mpix  reference %7.3fms (%6.1f Mpix/s)  bits %7.3fms (%6.1f Mpix/s)  tiles %7.3fms (%6.1f Mpix/s, %5.1f%% hits)  baked %7.3fms (%6.1f Mpix/s)\n",
+			"total", bench_totals.mpix,
+			bench_totals.reference_ms, bench_totals.mpix / bench_totals.reference_ms * 1000.0,
+			bench_totals.bits_ms, bench_totals.mpix / bench_totals.bits_ms * 1000.0,
+			bench_totals.slow_ms, bench_totals.mpix / bench_totals.slow_ms * 1000.0,
+			100.0 * bench_totals.tile_hits / MAX(bench_totals.tile_hits + bench_totals.tile_misses, 1),
+			bench_totals.baked_ms, bench_totals.mpix / bench_totals.baked_ms * 1000.0);
+		printf("%-28s %7.3fms  %zu KiB of cells vs. %zu KiB of pixels\n",
+			"cells", bench_totals.cells_ms,
+			bench_totals.cells_bytes / 1024, bench_totals.pixels_bytes / 1024);
+		printf("%-28s %6.1fns per overlap test on average\n",
+			"bitmask", bench_totals.bitmask_ns / bench_totals.n_assets);
+	}
+
+	return EXIT_SUCCESS;
+}
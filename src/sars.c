@@ -22,11 +22,18 @@
 #include <time.h> /* for time() */
 #include <unistd.h> /* for getpid() */
 
+#include "ansr-tex.h"
+#include "cache-node.h"
 #include "clear-node.h"
+#include "gl-ext.h"
+#include "gl-state.h"
 #include "glad.h"
+#include "loader.h"
 #include "m4f-3dx.h"
 #include "macros.h"
 #include "sars.h"
+#include "shader.h"
+#include "tex.h"
 
 #define SARS_DEFAULT_WIDTH	800
 #define SARS_DEFAULT_HEIGHT	600
@@ -40,6 +47,22 @@
 
 #define SARS_DEFAULT_DELAY_SECS	10
 
+#define SARS_LOADER_MAX_THREADS	4
+
+#define SARS_DRAWS_INTERVAL_MS	5000
+
+#define SARS_DEFAULT_LOAD_SLICE_US	4000
+#define SARS_DEFAULT_LOAD_SLICE_ROWS	4
+
+#define SARS_DEFAULT_PLASMA_SCALE	.5f
+
+/* --dynres steps the plasma scale by SARS_DYNRES_STEP within SARS_DYNRES_MIN_SCALE..1
+ * at most every SARS_DYNRES_FRAMES, the steps are coarse since each one takes a new texture.
+ */
+#define SARS_DYNRES_STEP	.125f
+#define SARS_DYNRES_MIN_SCALE	.25f
+#define SARS_DYNRES_FRAMES	30
+
 #define SARS_WINDOW_FLAGS	(SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL | SDL_WINDOW_ALLOW_HIGHDPI)
 
 
@@ -202,6 +225,7 @@ static void sars_update_projection_x(sars_t *sars)
 		sars->projection_x = sars_boxed_projection_x(sars);
 
 	sars->projection_x_inv = m4f_invert(&sars->projection_x);
+	sars->projection_version = gl_state_version();
 }
 
 
@@ -266,6 +290,39 @@ static int sars_parse_argv(sars_t *sars, int argc, char *argv[])
 			}
 		} else if (!strcmp(flag, "--wait")) {
 			sars->wait = 1;
+		} else if (!strcmp(flag, "--stats")) {
+			sars->stats = 1;
+		} else if (!strcmp(flag, "--sync-uploads")) {
+			sars->sync_uploads = 1;
+		} else if (!strcmp(flag, "--indexed-textures")) {
+			sars->texture_format = ANSR_TEX_FORMAT_INDEXED;
+		} else if (!strcmp(flag, "--cell-textures")) {
+			sars->texture_format = ANSR_TEX_FORMAT_CELLS;
+		} else if (!strcmp(flag, "--atlas")) {
+			sars->atlas = 1;
+		} else if (!strcmp(flag, "--sprite-lod")) {
+			sars->sprite_lod = 1;
+		} else if (!strcmp(flag, "--load-slice")) {
+			if (i + 1 < argc && argv[i + 1][0] != '-' && argv[i + 1][1] != '-') {
+				/* --load-slice MICROSECONDS[,ROWS] */
+				sscanf(argv[i + 1], "%u,%u", &sars->load_slice_us, &sars->load_slice_rows); /* FIXME: parse errors */
+				i++;
+			}
+		} else if (!strcmp(flag, "--plasma-scale")) {
+			if (i + 1 < argc && argv[i + 1][0] != '-' && argv[i + 1][1] != '-') {
+				/* --plasma-scale FRACTION */
+				sscanf(argv[i + 1], "%f", &sars->plasma_scale); /* FIXME: parse errors */
+				sars->plasma_scale = MIN(MAX(sars->plasma_scale, SARS_DYNRES_MIN_SCALE), 1.f);
+				i++;
+			}
+		} else if (!strcmp(flag, "--plasma-lut")) {
+			sars->plasma_lut = 1;
+		} else if (!strcmp(flag, "--dynres")) {
+			if (i + 1 < argc && argv[i + 1][0] != '-' && argv[i + 1][1] != '-') {
+				/* --dynres MILLISECONDS */
+				sscanf(argv[i + 1], "%f", &sars->dynres_ms); /* FIXME: parse errors */
+				i++;
+			}
 		} else {
 			warn_if(1, "Unsupported flag \"%s\", ignoring", argv[i]);
 		} /* TODO: add --fullscreen? */
@@ -278,9 +335,12 @@ static int sars_parse_argv(sars_t *sars, int argc, char *argv[])
 static void * sars_init(play_t *play, int argc, char *argv[], unsigned flags)
 {
 	sars_t	*sars;
-	char	*base;
+	char	*base, *pref;
+	int	w, h;
 
-	/* in case we're executed outside our dir, try chdir to it for assets/ */
+	/* in case we're executed outside our dir, try chdir to it for assets/,
+	 * the sprites are all embedded but music and sfx are still loaded from there.
+	 */
 	warn_if(!(base = SDL_GetBasePath()), "unable to get base path");
 	if (base) {
 		warn_if(chdir(base) < 0, "unable to chdir(\"%s\")", base);
@@ -290,6 +350,8 @@ static void * sars_init(play_t *play, int argc, char *argv[], unsigned flags)
 	sars = calloc(1, sizeof(sars_t));
 	fatal_if(!sars, "Unable to allocate sars_t");
 
+	sars->startup_counter = SDL_GetPerformanceCounter();
+
 	sars->stage = stage_new(&(stage_conf_t){.name = "sars", .active = 1, .alpha = 1.f}, NULL, NULL);
 	fatal_if(!sars->stage, "Unable to create new stage");
 
@@ -298,6 +360,9 @@ static void * sars_init(play_t *play, int argc, char *argv[], unsigned flags)
 	sars->window_width = SARS_DEFAULT_WIDTH;
 	sars->window_height = SARS_DEFAULT_HEIGHT;
 	sars->winmode = SARS_DEFAULT_WINMODE;
+	sars->load_slice_us = SARS_DEFAULT_LOAD_SLICE_US;
+	sars->load_slice_rows = SARS_DEFAULT_LOAD_SLICE_ROWS;
+	sars->plasma_scale = SARS_DEFAULT_PLASMA_SCALE;
 
 	fatal_if(sars_parse_argv(sars, argc, argv) < 0, "Unable to parse argv");
 
@@ -384,6 +449,17 @@ static void * sars_init(play_t *play, int argc, char *argv[], unsigned flags)
 	fatal_if(!gladLoadGLES2Loader(SDL_GL_GetProcAddress),
 		"Failed to initialize GLAD GLES 2.0 loader");
 
+	gl_ext_init();
+
+	/* WebGL has no program binaries to cache */
+#ifndef __EMSCRIPTEN__
+	warn_if(!(pref = SDL_GetPrefPath("pengaru", "sars")), "unable to get pref path, not caching shaders");
+	if (pref) {
+		shader_cache_init(pref);
+		SDL_free(pref);
+	}
+#endif
+
 	//This seems unnecessary now that the game grabs the mouse,
 	//and it's undesirable with clickable UI elements outside the
 	//gameplay - otherwise I'd have to draw a pointer.
@@ -395,6 +471,21 @@ static void * sars_init(play_t *play, int argc, char *argv[], unsigned flags)
 
 	sars_update_projection_x(sars);
 
+	ansr_tex_set_format(sars->texture_format);
+	ansr_tex_set_lod(sars->sprite_lod);
+	sars_canvas_size(sars, &w, &h);
+	ansr_tex_set_canvas_size(w, h);
+
+	/* Asset decoding gets kicked off by the later contexts' init, so the
+	 * loader must be ready before returning.  Leave a core for the GL thread.
+	 * There's no context sharing w/WebGL, so emscripten always uploads synchronously.
+	 */
+#ifdef __EMSCRIPTEN__
+	loader_init(0, NULL);
+#else
+	loader_init(MAX(1, MIN(SDL_GetCPUCount() - 1, SARS_LOADER_MAX_THREADS)), sars->sync_uploads ? NULL : sars->window);
+#endif
+
 	/* sars uses rand() a lot, but every game should be different. */
 	srand(time(NULL) + getpid());
 
@@ -408,15 +499,131 @@ static void sars_update(play_t *play, void *context)
 }
 
 
+static double sars_ms_since_startup(sars_t *sars)
+{
+	return (double)(SDL_GetPerformanceCounter() - sars->startup_counter) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+
+/* with --stats, report how many draw calls the sprites took per frame every SARS_DRAWS_INTERVAL_MS,
+ * and how many GL state changes everything made.
+ */
+static void sars_count_draws(sars_t *sars)
+{
+	Uint64		now = SDL_GetPerformanceCounter();
+	unsigned	draws, sprites, changes, skipped, hits, misses, bypasses;
+
+	if (!sars->stats)
+		return;
+
+	sars->draws_frames++;
+	if (now - sars->draws_counter < SARS_DRAWS_INTERVAL_MS * SDL_GetPerformanceFrequency() / 1000)
+		return;
+
+	tex_draw_stats(&draws, &sprites);
+	gl_state_stats(&changes, &skipped);
+	cache_node_stats(&hits, &misses, &bypasses);
+	if (sars->draws_counter) {
+		fprintf(stderr, "Stats: %.1f sprites in %.1f draw calls per frame, %.1f GL state changes w/%.1f redundant ones skipped\n",
+			(float)(sprites - sars->sprites) / sars->draws_frames,
+			(float)(draws - sars->draws) / sars->draws_frames,
+			(float)(changes - sars->state_changes) / sars->draws_frames,
+			(float)(skipped - sars->state_skipped) / sars->draws_frames);
+		fprintf(stderr, "Stats: %.1f cache node hits, %.1f misses, %.1f bypasses per frame\n",
+			(float)(hits - sars->cache_hits) / sars->draws_frames,
+			(float)(misses - sars->cache_misses) / sars->draws_frames,
+			(float)(bypasses - sars->cache_bypasses) / sars->draws_frames);
+	}
+
+	sars->draws_counter = now;
+	sars->draws_frames = 0;
+	sars->draws = draws;
+	sars->sprites = sprites;
+	sars->state_changes = changes;
+	sars->state_skipped = skipped;
+	sars->cache_hits = hits;
+	sars->cache_misses = misses;
+	sars->cache_bypasses = bypasses;
+}
+
+
+/* with --dynres, nudge the plasma scale to keep the frames taking around
+ * dynres_ms.  The plasma is the only part of the scene bound by the canvas'
+ * resolution, so it's what gets scaled.  Frames are timed between swaps, so
+ * w/vsync the target shouldn't be below the display's refresh interval.
+ */
+static void sars_dynres(sars_t *sars)
+{
+	Uint64	now = SDL_GetPerformanceCounter();
+	float	ms, scale = sars->plasma_scale;
+
+	if (!sars->dynres_ms)
+		return;
+
+	if (!sars->dynres_counter) {
+		sars->dynres_counter = now;
+		return;
+	}
+
+	ms = (float)(now - sars->dynres_counter) * 1000.f / (float)SDL_GetPerformanceFrequency();
+	sars->dynres_counter = now;
+	sars->dynres_frame_ms += (ms - sars->dynres_frame_ms) * .1f;
+
+	if (++sars->dynres_frames < SARS_DYNRES_FRAMES)
+		return;
+
+	sars->dynres_frames = 0;
+	if (sars->dynres_frame_ms > sars->dynres_ms * 1.1f)
+		scale = MAX(scale - SARS_DYNRES_STEP, SARS_DYNRES_MIN_SCALE);
+	else if (sars->dynres_frame_ms < sars->dynres_ms * .8f)
+		scale = MIN(scale + SARS_DYNRES_STEP, 1.f);
+
+	if (scale != sars->plasma_scale && sars->stats)
+		fprintf(stderr, "Stats: frames taking %.2fms, plasma scale %.3f -> %.3f\n", sars->dynres_frame_ms, sars->plasma_scale, scale);
+
+	sars->plasma_scale = scale;
+}
+
+
 /* XXX: note render and dispatch are public and ignore the passed-in context,
  * so other contexts can use these as-is for convenience */
 void sars_render(play_t *play, void *context)
 {
 	sars_t	*sars = play_context(play, SARS_CONTEXT_SARS);
 
+	/* when there are no loader threads, the loading happens here behind the
+	 * splash, and later on any sprites getting relevelled on resizes.
+	 */
+	(void) loader_slice(sars->load_slice_us, MAX(sars->load_slice_rows, 1));
+
+	/* finish whatever the loader has decoded in the background */
+	if (!loader_service() && !sars->assets_ready) {
+		sars->assets_ready = 1;
+		if (sars->stats) {
+			unsigned	hits, misses;
+			double		saved_ms;
+
+			fprintf(stderr, "Stats: all assets ready after %.2fms, %u frames, %zuKiB of textures resident\n",
+				sars_ms_since_startup(sars), loader_frames(), tex_resident_bytes() / 1024);
+
+			shader_cache_stats(&hits, &misses, &saved_ms);
+			fprintf(stderr, "Stats: shader cache %u hits, %u misses, %.2fms of compiling saved\n", hits, misses, saved_ms);
+		}
+	}
+
 	if (stage_render(sars->stage, play)) {
+		tex_flush();
+		sars_count_draws(sars);
 		SDL_GL_SwapWindow(sars->window);
+		sars_dynres(sars);
+
+		if (!sars->first_frame_done) {
+			sars->first_frame_done = 1;
+			if (sars->stats)
+				fprintf(stderr, "Stats: first frame after %.2fms\n", sars_ms_since_startup(sars));
+		}
 	} else {
+		sars->dynres_counter = 0;	/* the idle time isn't a frame */
 		SDL_Delay(100);	// FIXME: this should be computed
 	}
 }
@@ -435,12 +642,17 @@ void sars_dispatch(play_t *play, void *context, SDL_Event *event)
 		sars_canvas_size(sars, &w, &h);
 		glViewport(0, 0, w, h);
 		sars_update_projection_x(sars);
+		ansr_tex_set_canvas_size(w, h);
 		stage_dirty(sars->stage);
 	}
 
 	/* cycle fullscreen/windowed winmodes */
 	if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_f)
 		sars_winmode_set(sars, (sars->winmode + 1) % SARS_WINMODE_CNT);
+
+	/* toggle the cheaper plasma, for comparing them */
+	if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_p)
+		sars->plasma_lut = !sars->plasma_lut;
 }
 
 
@@ -21,6 +21,7 @@
 
 #include <stage.h>
 
+#include "ansr-tex.h"
 #include "m4f.h"
 
 typedef enum sars_context_t {
@@ -45,10 +46,35 @@ typedef struct sars_t {
 	sars_winmode_t	winmode;
 	unsigned	cheat:1;
 	unsigned	wait:1;
+	unsigned	stats:1;
+	unsigned	sync_uploads:1;
+	unsigned	sprite_lod:1;
+	unsigned	atlas:1;
 	unsigned	delay_seconds;
+	unsigned	load_slice_us, load_slice_rows;	/* cooperative loading budget per frame */
+	ansr_tex_format_t	texture_format;
+
+	/* startup timing, reported w/--stats */
+	Uint64		startup_counter;
+	unsigned	first_frame_done:1;
+	unsigned	assets_ready:1;
+
+	/* sprite draw calls per frame, reported periodically w/--stats */
+	Uint64		draws_counter;
+	unsigned	draws_frames, draws, sprites;
+	unsigned	state_changes, state_skipped;
+	unsigned	cache_hits, cache_misses, cache_bypasses;
+
+	/* the fraction of the canvas' resolution the plasma renders at, adjusted w/--dynres */
+	float		plasma_scale;
+	unsigned	plasma_lut;	/* render the plasma from lookup textures, toggled w/'p' */
+	float		dynres_ms, dynres_frame_ms;	/* target and smoothed frame times */
+	Uint64		dynres_counter;
+	unsigned	dynres_frames;
 
 	m4f_t		projection_x;
 	m4f_t		projection_x_inv;
+	unsigned	projection_version;	/* see gl_state_version() */
 } sars_t;
 
 void sars_canvas_size(sars_t *sars, int *res_width, int *res_height);
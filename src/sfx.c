@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <SDL_mixer.h>
 
+#include "loader.h"
 #include "sfx.h"
 
 sfx_t	sfx;
@@ -27,8 +28,11 @@ static void sfx_load(sfx_voice_t voice, const char *path, sfx_sound_t *res_sound
 	assert(path);
 	assert(res_sound);
 
+	/* the chunk gets filled in by the loader in the background, sfx_play()
+	 * simply skips sounds which haven't finished loading yet.
+	 */
 	(*res_sound).voice = voice;
-	(*res_sound).chunk = Mix_LoadWAV(path);
+	loader_queue_wav(path, &(*res_sound).chunk);
 }
 
 
@@ -19,11 +19,13 @@
 
 #include <stage.h>
 
+#include "gl-state.h"
 #include "glad.h"
 #include "m4f.h"
 #include "macros.h"
 #include "shader.h"
 #include "shader-node.h"
+#include "tex.h"
 #include "v2f.h"
 
 
@@ -35,33 +37,27 @@ typedef struct shader_node_t {
 		shader_node_uniforms_func_t	*uniforms_func;
 		void				*uniforms_ctxt;
 		const m4f_t			*transform;
+		const unsigned			*transform_version;
+		gl_state_vertex_array_t		array;	/* vbo for the shader's attributes */
 	}				shaders[];
 } shader_node_t;
 
-static unsigned	vbo, tcbo;
+static unsigned	vbo;
 
-static const float	vertices[] = {
-	+1.f, +1.f, 0.f,
-	+1.f, -1.f, 0.f,
-	-1.f, +1.f, 0.f,
-	+1.f, -1.f, 0.f,
-	-1.f, -1.f, 0.f,
-	-1.f, +1.f, 0.f,
-};
-
-
-/* TODO: verify that this is OK, I recall tutorials stating these are always
+/* vertices interleaved w/texcoords
+ *
+ * TODO: verify that this is OK, I recall tutorials stating texcoords are always
  * in the range 0-1, but it seems perfectly OK to use -1..+1 which is more
  * convenient here where these shader-textured quads appreciate being fed 
  * unit square coordinates with 0,0 @ the center.
  */
-static const float	texcoords[] = {
-	1.f, 1.f,
-	1.f, -1.f,
-	-1.f, 1.f,
-	1.f, -1.f,
-	-1.f, -1.f,
-	-1.f, 1.f,
+static const float	vertices[] = {
+	+1.f, +1.f, 0.f,	1.f, 1.f,
+	+1.f, -1.f, 0.f,	1.f, -1.f,
+	-1.f, +1.f, 0.f,	-1.f, 1.f,
+	+1.f, -1.f, 0.f,	1.f, -1.f,
+	-1.f, -1.f, 0.f,	-1.f, -1.f,
+	-1.f, +1.f, 0.f,	-1.f, 1.f,
 };
 
 
@@ -80,30 +76,38 @@ static stage_render_func_ret_t shader_node_render(const stage_t *stage, void *ob
 
 	assert(idx < shader_node->n_shaders);
 
+	/* draw any sprites queued before us first */
+	tex_flush();
+
 	shader_use(shader_node->shaders[idx].shader, &n_uniforms, &uniforms, NULL, &attributes);
 
 	if (shader_node->shaders[idx].uniforms_func)
-		shader_node->shaders[idx].uniforms_func(shader_node->shaders[idx].uniforms_ctxt, render_ctxt, n_uniforms, uniforms, shader_node->shaders[idx].transform, alpha);
-
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glVertexAttribPointer(attributes[0], 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(attributes[0]);
-
-	glBindBuffer(GL_ARRAY_BUFFER, tcbo);
-	glVertexAttribPointer(attributes[1], 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-	glEnableVertexAttribArray(attributes[1]);
+		shader_node->shaders[idx].uniforms_func(shader_node->shaders[idx].uniforms_ctxt, render_ctxt, n_uniforms, uniforms,
+							shader_node->shaders[idx].transform,
+							shader_node->shaders[idx].transform_version ? *(shader_node->shaders[idx].transform_version) : 0,
+							alpha);
+
+	if (!shader_node->shaders[idx].array.buffer) {
+		shader_node->shaders[idx].array = (gl_state_vertex_array_t){
+							.buffer = vbo,
+							.stride = 5 * sizeof(float),
+							.n_attributes = 2,
+							.attributes = {
+								{ attributes[0], 3, 0 },
+								{ attributes[1], 2, 3 * sizeof(float) },
+							},
+						};
+	}
+	gl_state_bind_vertex_array(&shader_node->shaders[idx].array);
 
 	/* XXX: this could be made optional, but since alpha is a constant throughout the stage
 	 * integration I'm just always turning it on so stage_set_alpha() always works.  There
 	 * are definitely full-screen full-opaque shader node situations where the pointless
 	 * performance hit sucks though, especially on older hardware.
 	 */
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	gl_state_blend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glUseProgram(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	return STAGE_RENDER_FUNC_RET_CONTINUE;
 }
@@ -117,8 +121,10 @@ static void shader_node_free(const stage_t *stage, void *object)
 	assert(shader_node);
 
 	/* XXX FIXME: hmm, maybe the caller should supply a shader_t ** instead */
-	for (unsigned i = 0; i < shader_node->n_shaders; i++)
+	for (unsigned i = 0; i < shader_node->n_shaders; i++) {
+		gl_state_vertex_array_fini(&shader_node->shaders[i].array);
 		(void) shader_free(shader_node->shaders[i].shader);
+	}
 	free(shader_node);
 }
 
@@ -147,13 +153,8 @@ stage_t * shader_node_new_shaderv(const stage_conf_t *conf, unsigned n_shader_co
 	if (!vbo) {
 		/* common to all shader nodes */
 		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		gl_state_bind_array_buffer(vbo);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &tcbo);
-		glBindBuffer(GL_ARRAY_BUFFER, tcbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	shader_node = calloc(1, sizeof(shader_node_t) + n_shader_confs * sizeof(shader_node->shaders[0]));
@@ -166,6 +167,7 @@ stage_t * shader_node_new_shaderv(const stage_conf_t *conf, unsigned n_shader_co
 		shader_node->shaders[i].uniforms_func = shader_confs[i].uniforms_func;
 		shader_node->shaders[i].uniforms_ctxt = shader_confs[i].uniforms_ctxt;
 		shader_node->shaders[i].transform = shader_confs[i].transform;
+		shader_node->shaders[i].transform_version = shader_confs[i].transform_version;
 	}
 
 	stage = stage_new(conf, &shader_node_ops, shader_node);
@@ -204,6 +206,7 @@ stage_t * shader_node_new_srcv(const stage_conf_t *conf, unsigned n_shader_src_c
 						}
 					);
 		shader_confs[i].transform = shader_src_confs[i].transform;
+		shader_confs[i].transform_version = shader_src_confs[i].transform_version;
 		shader_confs[i].uniforms_func = shader_src_confs[i].uniforms_func;
 		shader_confs[i].uniforms_ctxt = shader_src_confs[i].uniforms_ctxt;
 	}
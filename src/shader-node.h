@@ -22,11 +22,13 @@ typedef struct stage_t stage_t;
 typedef struct stage_conf_t stage_conf_t;
 typedef struct m4f_t m4f_t;
 
-typedef void (shader_node_uniforms_func_t)(void *uniforms_ctxt, void *render_ctxt, unsigned n_uniforms, const int *uniforms, const m4f_t *transform, float alpha);
+/* transform_version is *transform_version from the conf or 0, for gl_state_uniform_m4f() */
+typedef void (shader_node_uniforms_func_t)(void *uniforms_ctxt, void *render_ctxt, unsigned n_uniforms, const int *uniforms, const m4f_t *transform, unsigned transform_version, float alpha);
 
 typedef struct shader_conf_t {
 	shader_t			*shader;
 	const m4f_t			*transform;
+	const unsigned			*transform_version;	/* optional, see gl_state_version() */
 	shader_node_uniforms_func_t	*uniforms_func;
 	void				*uniforms_ctxt;
 } shader_conf_t;
@@ -34,6 +36,7 @@ typedef struct shader_conf_t {
 typedef struct shader_src_conf_t {
 	const char			*vs_src, *fs_src;
 	const m4f_t			*transform;
+	const unsigned			*transform_version;	/* optional, see gl_state_version() */
 	shader_node_uniforms_func_t	*uniforms_func;
 	void				*uniforms_ctxt;
 	unsigned			n_uniforms;
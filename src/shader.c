@@ -14,15 +14,66 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <SDL.h>
 #include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "gl-ext.h"
+#include "gl-state.h"
 #include "glad.h"
 #include "macros.h"
 #include "shader.h"
 
+/* Linked programs get cached on disk as program binaries when the driver
+ * supports it, one file per program named after the hash of its sources and
+ * the GL vendor/renderer/version.  The hash gets checked again on load, and
+ * the driver may still reject the binary (e.g. after a driver update without
+ * a version change), either way the program just gets compiled again and its
+ * file rewritten.
+ */
+#define SHADER_CACHE_MAGIC	"SARSPRG1"
+
+typedef struct shader_cache_header_t {
+	char		magic[8];
+	uint64_t	hash;
+	uint32_t	format, length;
+	float		compile_ms;	/* what compiling it from source took */
+} shader_cache_header_t;
+
+static struct {
+	char		*dir;
+	unsigned	hits, misses;
+	double		saved_ms;
+} shader_cache;
+
+
+/* Programs and their compiled stages are shared by source text, which is
+ * expected to be static as it's referenced rather than copied.  Stages stay
+ * compiled for the life of the context, programs while any shader_t uses
+ * them.
+ */
+typedef struct shader_stage_t shader_stage_t;
+struct shader_stage_t {
+	shader_stage_t	*next;
+	unsigned	type, object;
+	const char	*src;
+};
+
+typedef struct shader_program_t shader_program_t;
+struct shader_program_t {
+	shader_program_t	*next;
+	unsigned		program, refcnt;
+	const char		*vs_src, *fs_src;
+};
+
+static shader_stage_t	*shader_stages;
+static shader_program_t	*shader_programs;
 
 typedef struct shader_t {
+	shader_program_t	*shared;
 	unsigned	program, refcnt;
 	unsigned	n_uniforms, n_attributes;
 	int		*uniforms, *attributes;
@@ -31,33 +82,212 @@ typedef struct shader_t {
 } shader_t;
 
 
-unsigned int shader_pair_new_bare(const char *vs_src, const char *fs_src)
+/* cache linked programs as binaries under dir, which must end in a path separator */
+void shader_cache_init(const char *dir)
 {
-	unsigned int	vertex_shader, fragment_shader, shader;
-	int		shader_success;
-	char		shader_info[4096];
+	assert(dir);
 
-	vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex_shader, 1, &vs_src, NULL);
-	glCompileShader(vertex_shader);
-	glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &shader_success);
-	if (!shader_success) {
-		glGetShaderInfoLog(vertex_shader, sizeof(shader_info), NULL, shader_info);
-		fatal_if(1, "Error compiling vertex shader: \"%s\"", shader_info);
+	if (!gl_ext.program_binary)
+		return;
+
+	free(shader_cache.dir);
+	shader_cache.dir = strdup(dir);
+	fatal_if(!shader_cache.dir, "unable to allocate shader cache dir");
+}
+
+
+void shader_cache_stats(unsigned *res_hits, unsigned *res_misses, double *res_saved_ms)
+{
+	if (res_hits)
+		*res_hits = shader_cache.hits;
+
+	if (res_misses)
+		*res_misses = shader_cache.misses;
+
+	if (res_saved_ms)
+		*res_saved_ms = shader_cache.saved_ms;
+}
+
+
+/* FNV-1a over str including its terminator */
+static uint64_t shader_cache_hash_str(uint64_t hash, const char *str)
+{
+	if (!str)
+		str = "";
+
+	do {
+		hash ^= (unsigned char)*str;
+		hash *= 0x100000001b3ull;
+	} while (*str++);
+
+	return hash;
+}
+
+
+static uint64_t shader_cache_hash(const char *vs_src, const char *fs_src)
+{
+	uint64_t	hash = 0xcbf29ce484222325ull;
+
+	hash = shader_cache_hash_str(hash, vs_src);
+	hash = shader_cache_hash_str(hash, fs_src);
+	hash = shader_cache_hash_str(hash, (const char *)glGetString(GL_VENDOR));
+	hash = shader_cache_hash_str(hash, (const char *)glGetString(GL_RENDERER));
+	hash = shader_cache_hash_str(hash, (const char *)glGetString(GL_VERSION));
+
+	return hash;
+}
+
+
+static FILE * shader_cache_open(uint64_t hash, const char *mode)
+{
+	char	path[strlen(shader_cache.dir) + sizeof("shader-0123456789abcdef.bin")];
+
+	snprintf(path, sizeof(path), "%sshader-%016llx.bin", shader_cache.dir, (unsigned long long)hash);
+
+	return fopen(path, mode);
+}
+
+
+static double shader_cache_ms_since(Uint64 start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+
+/* returns the cached program for hash, or 0 when missing or unusable */
+static unsigned int shader_cache_load(uint64_t hash)
+{
+	shader_cache_header_t	header;
+	Uint64			start = SDL_GetPerformanceCounter();
+	unsigned int		program = 0;
+	void			*binary = NULL;
+	double			saved_ms;
+	int			linked = 0;
+	FILE			*f;
+
+	f = shader_cache_open(hash, "rb");
+	if (!f)
+		return 0;
+
+	if (fread(&header, sizeof(header), 1, f) != 1 ||
+	    memcmp(header.magic, SHADER_CACHE_MAGIC, sizeof(header.magic)) ||
+	    header.hash != hash)
+		goto out;
+
+	binary = malloc(header.length);
+	if (!binary || fread(binary, header.length, 1, f) != 1)
+		goto out;
+
+	program = glCreateProgram();
+	gl_ext.ProgramBinary(program, header.format, binary, header.length);
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked) {
+		debugf("shader cache: binary %016llx rejected by the driver", (unsigned long long)hash);
+		glDeleteProgram(program);
+		program = 0;
+		goto out;
 	}
 
-	fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment_shader, 1, &fs_src, NULL);
-	glCompileShader(fragment_shader);
-	glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &shader_success);
-	if (!shader_success) {
-		glGetShaderInfoLog(fragment_shader, sizeof(shader_info), NULL, shader_info);
-		fatal_if(1, "Error compiling fragment shader: \"%s\"", shader_info);
+	saved_ms = header.compile_ms - shader_cache_ms_since(start);
+	shader_cache.hits++;
+	shader_cache.saved_ms += saved_ms;
+	debugf("shader cache: loaded %016llx, saved %.2fms of compiling", (unsigned long long)hash, saved_ms);
+
+out:
+	free(binary);
+	fclose(f);
+
+	return program;
+}
+
+
+static void shader_cache_store(uint64_t hash, unsigned int program, double compile_ms)
+{
+	shader_cache_header_t	header = {
+					.magic = SHADER_CACHE_MAGIC,
+					.hash = hash,
+					.compile_ms = compile_ms,
+				};
+	void			*binary;
+	GLint			length = 0;
+	GLenum			format;
+	FILE			*f;
+
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	binary = malloc(length);
+	if (!binary)
+		return;
+
+	gl_ext.GetProgramBinary(program, length, &length, &format, binary);
+	header.format = format;
+	header.length = length;
+
+	f = shader_cache_open(hash, "wb");
+	if (f) {
+		if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+		    fwrite(binary, length, 1, f) != 1)
+			warn_if(1, "unable to write shader cache entry %016llx", (unsigned long long)hash);
+
+		fclose(f);
 	}
 
+	free(binary);
+}
+
+
+static int shader_src_eq(const char *a, const char *b)
+{
+	return a == b || !strcmp(a, b);
+}
+
+
+/* get the compiled stage of type for src, compiling it on first use */
+static unsigned int shader_stage_get(unsigned type, const char *src)
+{
+	shader_stage_t	*stage;
+	int		success;
+	char		info[4096];
+
+	for (stage = shader_stages; stage; stage = stage->next) {
+		if (stage->type == type && shader_src_eq(stage->src, src))
+			return stage->object;
+	}
+
+	stage = calloc(1, sizeof(shader_stage_t));
+	fatal_if(!stage, "Unable to allocate shader stage");
+
+	stage->type = type;
+	stage->src = src;
+	stage->object = glCreateShader(type);
+	glShaderSource(stage->object, 1, &src, NULL);
+	glCompileShader(stage->object);
+	glGetShaderiv(stage->object, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(stage->object, sizeof(info), NULL, info);
+		fatal_if(1, "Error compiling %s shader: \"%s\"", type == GL_VERTEX_SHADER ? "vertex" : "fragment", info);
+	}
+
+	stage->next = shader_stages;
+	shader_stages = stage;
+
+	return stage->object;
+}
+
+
+static unsigned int shader_pair_compile(const char *vs_src, const char *fs_src)
+{
+	unsigned int	shader;
+	int		shader_success;
+	char		shader_info[4096];
+
 	shader = glCreateProgram();
-	glAttachShader(shader, vertex_shader);
-	glAttachShader(shader, fragment_shader);
+	glAttachShader(shader, shader_stage_get(GL_VERTEX_SHADER, vs_src));
+	glAttachShader(shader, shader_stage_get(GL_FRAGMENT_SHADER, fs_src));
+	if (shader_cache.dir && gl_ext.ProgramParameteri)
+		gl_ext.ProgramParameteri(shader, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(shader);
 	glGetProgramiv(shader, GL_LINK_STATUS, &shader_success);
 	if (!shader_success) {
@@ -65,13 +295,76 @@ unsigned int shader_pair_new_bare(const char *vs_src, const char *fs_src)
 		fatal_if(1, "Error linking shader program: \"%s\"", shader_info);
 	}
 
-	glDeleteShader(vertex_shader);
-	glDeleteShader(fragment_shader);
-
 	return shader;
 }
 
 
+unsigned int shader_pair_new_bare(const char *vs_src, const char *fs_src)
+{
+	Uint64		start;
+	unsigned int	program;
+	uint64_t	hash;
+
+	if (!shader_cache.dir)
+		return shader_pair_compile(vs_src, fs_src);
+
+	hash = shader_cache_hash(vs_src, fs_src);
+	program = shader_cache_load(hash);
+	if (program)
+		return program;
+
+	start = SDL_GetPerformanceCounter();
+	program = shader_pair_compile(vs_src, fs_src);
+	shader_cache.misses++;
+	shader_cache_store(hash, program, shader_cache_ms_since(start));
+
+	return program;
+}
+
+
+/* get the shared program for vs_src + fs_src, linking it on first use */
+static shader_program_t * shader_program_get(const char *vs_src, const char *fs_src)
+{
+	shader_program_t	*p;
+
+	for (p = shader_programs; p; p = p->next) {
+		if (shader_src_eq(p->vs_src, vs_src) && shader_src_eq(p->fs_src, fs_src)) {
+			p->refcnt++;
+
+			return p;
+		}
+	}
+
+	p = calloc(1, sizeof(shader_program_t));
+	fatal_if(!p, "Unable to allocate shader program");
+
+	p->vs_src = vs_src;
+	p->fs_src = fs_src;
+	p->program = shader_pair_new_bare(vs_src, fs_src);
+	p->refcnt = 1;
+
+	p->next = shader_programs;
+	shader_programs = p;
+
+	return p;
+}
+
+
+static void shader_program_put(shader_program_t *program)
+{
+	shader_program_t	**p;
+
+	if (--program->refcnt > 0)
+		return;
+
+	for (p = &shader_programs; *p != program; p = &(*p)->next);
+	*p = program->next;
+
+	gl_state_delete_program(program->program);
+	free(program);
+}
+
+
 shader_t * shader_pair_new(const char *vs_src, const char *fs_src, unsigned n_uniforms, const char **uniforms, unsigned n_attributes, const char **attributes)
 {
 	shader_t	*shader;
@@ -84,7 +377,8 @@ shader_t * shader_pair_new(const char *vs_src, const char *fs_src, unsigned n_un
 	shader = calloc(1, sizeof(shader_t) + (n_uniforms + n_attributes) * sizeof(int));
 	fatal_if(!shader, "Unable to allocate shader");
 
-	shader->program = shader_pair_new_bare(vs_src, fs_src);
+	shader->shared = shader_program_get(vs_src, fs_src);
+	shader->program = shader->shared->program;
 	shader->refcnt++;
 	shader->n_uniforms = n_uniforms;
 	shader->n_attributes = n_attributes;
@@ -119,7 +413,7 @@ shader_t * shader_free(shader_t *shader)
 	if (shader->refcnt > 0)
 		return shader;
 
-	glDeleteProgram(shader->program);
+	shader_program_put(shader->shared);
 	free(shader);
 
 	return NULL;
@@ -142,5 +436,80 @@ void shader_use(shader_t *shader, unsigned *res_n_uniforms, int **res_uniforms,
 	if (res_attributes)
 		*res_attributes = shader->attributes;
 
-	glUseProgram(shader->program);
+	gl_state_use_program(shader->program);
+}
+
+
+/* issue a draw w/every shared program into a throwaway 1x1 framebuffer, so
+ * drivers deferring their final compilation to a program's first draw do it
+ * now rather than whenever it's first used.  Returns the number of programs
+ * drawn with.  The degenerate triangle drawn doesn't produce any fragments.
+ */
+unsigned shader_warmup(void)
+{
+	static const float	vertices[3 * 4];
+	GLint			viewport[4], framebuffer, texture;
+	unsigned		fbo, tex, vbo, n = 0;
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+	glViewport(0, 0, 1, 1);
+
+	/* the attributes get pointed at the zeroes directly, keep that off of any
+	 * vertex array object the state cache has bound.
+	 */
+	gl_state_bind_vertex_array(NULL);
+
+	glGenBuffers(1, &vbo);
+	gl_state_bind_array_buffer(vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	for (shader_program_t *p = shader_programs; p; p = p->next, n++) {
+		GLint	n_attributes = 0, locations[16];
+
+		gl_state_use_program(p->program);
+
+		/* point every attribute at the zeroes, whatever they're called */
+		glGetProgramiv(p->program, GL_ACTIVE_ATTRIBUTES, &n_attributes);
+		n_attributes = MIN(n_attributes, NELEMS(locations));
+		for (GLint i = 0; i < n_attributes; i++) {
+			GLint	size;
+			GLenum	type;
+			char	name[64];
+
+			glGetActiveAttrib(p->program, i, sizeof(name), NULL, &size, &type, name);
+			locations[i] = glGetAttribLocation(p->program, name);
+			if (locations[i] < 0)
+				continue;
+
+			glVertexAttribPointer(locations[i], 4, GL_FLOAT, GL_FALSE, 0, NULL);
+			glEnableVertexAttribArray(locations[i]);
+		}
+
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+
+		for (GLint i = 0; i < n_attributes; i++) {
+			if (locations[i] >= 0)
+				glDisableVertexAttribArray(locations[i]);
+		}
+	}
+
+	gl_state_bind_array_buffer(0);
+	glDeleteBuffers(1, &vbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(1, &tex);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	return n;
 }
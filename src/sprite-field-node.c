@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A whole population of one sprite as a single node, drawn from an array of
+ * tex_instance_t owned by the caller w/tex_render_instances().  Where a tex
+ * node per sprite takes a node and a model_x each, this just takes updating
+ * the instances in place.  Instances w/motion animate by just updating the
+ * time, without touching the instances at all.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <stage.h>
+
+#include "macros.h"
+#include "sprite-field-node.h"
+#include "tex.h"
+
+typedef struct sprite_field_node_t {
+	tex_t			*tex;
+	m4f_t			*projection_x;
+	unsigned		*projection_version;
+	const float		*time;
+	const tex_instance_t	*instances;
+	const unsigned		*n_instances;
+} sprite_field_node_t;
+
+
+static stage_render_func_ret_t sprite_field_node_render(const stage_t *stage, void *object, float alpha, void *render_ctxt)
+{
+	sprite_field_node_t	*field = object;
+
+	assert(stage);
+	assert(field);
+
+	tex_render_instances(field->tex, alpha, field->projection_x,
+			     field->projection_version ? *(field->projection_version) : 0,
+			     field->time ? *(field->time) : 0.f,
+			     *(field->n_instances), field->instances);
+
+	return STAGE_RENDER_FUNC_RET_CONTINUE;
+}
+
+
+static void sprite_field_node_free(const stage_t *stage, void *object)
+{
+	sprite_field_node_t	*field = object;
+
+	assert(stage);
+	assert(field);
+
+	tex_free(field->tex);
+	free(field);
+}
+
+
+static const stage_ops_t sprite_field_node_ops = {
+	.render_func = sprite_field_node_render,
+	.free_func = sprite_field_node_free,
+};
+
+
+/* return a node drawing tex at the first *n_instances of instances, both of
+ * which must remain valid for the lifetime of the node.  projection_version is
+ * optional, see gl_state_version(), as is time for the instances' motion.
+ */
+stage_t * sprite_field_node_new(stage_conf_t *conf, tex_t *tex, m4f_t *projection_x, unsigned *projection_version, const float *time, const tex_instance_t *instances, const unsigned *n_instances)
+{
+	sprite_field_node_t	*field;
+	stage_t			*s;
+
+	assert(conf);
+	assert(tex);
+	assert(projection_x);
+	assert(instances);
+	assert(n_instances);
+
+	field = calloc(1, sizeof(sprite_field_node_t));
+	fatal_if(!field, "Unable to allocate sprite_field_node \"%s\"", conf->name);
+
+	s = stage_new(conf, &sprite_field_node_ops, field);
+	fatal_if(!s, "Unable to create stage \"%s\"", conf->name);
+
+	field->tex = tex_ref(tex);
+	field->projection_x = projection_x;
+	field->projection_version = projection_version;
+	field->time = time;
+	field->instances = instances;
+	field->n_instances = n_instances;
+
+	return s;
+}
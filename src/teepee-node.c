@@ -17,16 +17,32 @@
 #include <stage.h>
 
 #include "ansr-tex.h"
+#include "sprite-field-node.h"
 #include "teepee-node.h"
 #include "tex.h"
 #include "tex-node.h"
 
-static tex_t	*teepee_tex;
-
 stage_t * teepee_node_new(stage_conf_t *conf, m4f_t *projection_x, m4f_t *model_x)
 {
-	if (!teepee_tex)
-		teepee_tex = ansr_tex_new("assets/teepee.ans", "assets/teepee.mask.ans");
+	tex_t	*tex;
+	stage_t	*s;
+
+	tex = ansr_tex_new("assets/teepee.ans", "assets/teepee.mask.ans");
+	s = tex_node_new_tex(conf, tex, projection_x, model_x);
+	tex_free(tex);
+
+	return s;
+}
+
+
+stage_t * teepee_field_node_new(stage_conf_t *conf, m4f_t *projection_x, unsigned *projection_version, const float *time, const tex_instance_t *instances, const unsigned *n_instances)
+{
+	tex_t	*tex;
+	stage_t	*s;
+
+	tex = ansr_tex_new("assets/teepee.ans", "assets/teepee.mask.ans");
+	s = sprite_field_node_new(conf, tex, projection_x, projection_version, time, instances, n_instances);
+	tex_free(tex);
 
-	return tex_node_new_tex(conf, teepee_tex, projection_x, model_x);
+	return s;
 }
@@ -19,7 +19,9 @@
 
 typedef struct stage_conf_t stage_conf_t;
 typedef struct m4f_t m4f_t;
+typedef struct tex_instance_t tex_instance_t;
 
 stage_t * teepee_node_new(stage_conf_t *conf, m4f_t *projection_x, m4f_t *model_x);
+stage_t * teepee_field_node_new(stage_conf_t *conf, m4f_t *projection_x, unsigned *projection_version, const float *time, const tex_instance_t *instances, const unsigned *n_instances);
 
 #endif
@@ -0,0 +1,299 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Packs the texels of many textures into a few big atlas pages w/a shelf
+ * packer, then has the textures use their rects in the pages via tex_place().
+ *
+ * Textures get added along with their CPU-side pixels, which must remain valid
+ * until tex_atlas_pack().  The packing sorts them by height, tallest first,
+ * putting each on the first shelf with room left for it, or a new shelf below
+ * the last one, or a new page.  Pages are power of two sized so they're always
+ * mipmappable, and placements are aligned and spaced by TEX_ATLAS_ALIGN texels
+ * so the first log2(TEX_ATLAS_ALIGN) mip levels never mix neighbors.  Half
+ * of that spacing is filled with the textures' extruded edges, standing in for
+ * the GL_CLAMP_TO_EDGE they had on their own.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ansr-view.h"
+#include "bb2f.h"
+#include "glad.h"
+#include "macros.h"
+#include "tex.h"
+#include "tex-atlas.h"
+
+#define TEX_ATLAS_SIZE	2048
+#define TEX_ATLAS_ALIGN	16
+
+#define TEX_ATLAS_EXTRUDE	(TEX_ATLAS_ALIGN / 2)
+
+#define TEX_ATLAS_ALIGNED(_v)	(((_v) + TEX_ATLAS_ALIGN - 1) & ~(TEX_ATLAS_ALIGN - 1))
+
+typedef struct tex_atlas_entry_t {
+	tex_t		*tex;
+	int		width, height;
+	const void	*pixels;
+	int		page, x, y;	/* page is -1 when it doesn't fit any */
+} tex_atlas_entry_t;
+
+typedef struct tex_atlas_shelf_t {
+	int		page, y, height;
+	int		x;		/* where the next placement goes */
+} tex_atlas_shelf_t;
+
+struct tex_atlas_t {
+	int			indexed;	/* pixels are palette indices for tex_new_indexed() */
+	unsigned		n_entries, n_allocated;
+	tex_atlas_entry_t	*entries;
+};
+
+
+/* create an atlas for RGBA textures, or indexed ones when indexed is set */
+tex_atlas_t * tex_atlas_new(int indexed)
+{
+	tex_atlas_t	*atlas;
+
+	atlas = calloc(1, sizeof(tex_atlas_t));
+	fatal_if(!atlas, "unable to allocate tex_atlas_t");
+
+	atlas->indexed = indexed;
+
+	return atlas;
+}
+
+
+tex_atlas_t * tex_atlas_free(tex_atlas_t *atlas)
+{
+	if (!atlas)
+		return NULL;
+
+	free(atlas->entries);
+	free(atlas);
+
+	return NULL;
+}
+
+
+/* add tex to be packed, w/its width x height pixels or indices */
+void tex_atlas_add(tex_atlas_t *atlas, tex_t *tex, int width, int height, const void *pixels)
+{
+	assert(atlas);
+	assert(tex);
+	assert(pixels);
+
+	if (atlas->n_entries == atlas->n_allocated) {
+		tex_atlas_entry_t	*entries;
+
+		entries = realloc(atlas->entries, MAX(atlas->n_allocated * 2, 16) * sizeof(tex_atlas_entry_t));
+		fatal_if(!entries, "unable to grow atlas entries");
+
+		atlas->entries = entries;
+		atlas->n_allocated = MAX(atlas->n_allocated * 2, 16);
+	}
+
+	atlas->entries[atlas->n_entries++] = (tex_atlas_entry_t){
+						.tex = tex,
+						.width = width,
+						.height = height,
+						.pixels = pixels,
+						.page = -1,
+					};
+}
+
+
+static int tex_atlas_cmp(const void *a, const void *b)
+{
+	const tex_atlas_entry_t	*ea = a, *eb = b;
+
+	return eb->height - ea->height;
+}
+
+
+/* assign every entry a page and position, returns the number of pages */
+static unsigned tex_atlas_place(tex_atlas_t *atlas, int size)
+{
+	tex_atlas_shelf_t	*shelves;
+	unsigned		n_shelves = 0, n_pages = 0;
+
+	shelves = calloc(atlas->n_entries, sizeof(tex_atlas_shelf_t));
+	fatal_if(!shelves, "unable to allocate atlas shelves");
+
+	qsort(atlas->entries, atlas->n_entries, sizeof(tex_atlas_entry_t), tex_atlas_cmp);
+
+	for (unsigned i = 0; i < atlas->n_entries; i++) {
+		tex_atlas_entry_t	*e = &atlas->entries[i];
+		int			width = TEX_ATLAS_ALIGNED(e->width), height = TEX_ATLAS_ALIGNED(e->height);
+		tex_atlas_shelf_t	*shelf = NULL;
+
+		e->page = -1;
+		if (width > size || height > size)
+			continue;
+
+		/* tallest first means every existing shelf is tall enough */
+		for (unsigned j = 0; j < n_shelves; j++) {
+			if (shelves[j].x + width <= size) {
+				shelf = &shelves[j];
+				break;
+			}
+		}
+
+		if (!shelf) {
+			tex_atlas_shelf_t	*last = n_shelves ? &shelves[n_shelves - 1] : NULL;
+
+			shelf = &shelves[n_shelves++];
+			if (last && last->y + last->height + TEX_ATLAS_ALIGN + height <= size) {
+				shelf->page = last->page;
+				shelf->y = last->y + last->height + TEX_ATLAS_ALIGN;
+			} else {
+				shelf->page = n_pages++;
+				shelf->y = 0;
+			}
+			shelf->height = height;
+			shelf->x = 0;
+		}
+
+		e->page = shelf->page;
+		e->x = shelf->x;
+		e->y = shelf->y;
+		shelf->x += width + TEX_ATLAS_ALIGN;
+	}
+
+	free(shelves);
+
+	return n_pages;
+}
+
+
+/* copy e's texels into its spot on the page, extruding its edges by
+ * TEX_ATLAS_EXTRUDE texels into the spacing around it so filtering at the
+ * edges sees what GL_CLAMP_TO_EDGE would have given the standalone texture.
+ */
+static void tex_atlas_blit(const tex_atlas_entry_t *e, unsigned char *page, int width, int height, size_t bpp)
+{
+	const unsigned char	*pixels = e->pixels;
+	int			x0 = MAX(e->x - TEX_ATLAS_EXTRUDE, 0), x1 = MIN(e->x + e->width + TEX_ATLAS_EXTRUDE, width);
+	int			y0 = MAX(e->y - TEX_ATLAS_EXTRUDE, 0), y1 = MIN(e->y + e->height + TEX_ATLAS_EXTRUDE, height);
+
+	for (int y = y0; y < y1; y++) {
+		const unsigned char	*src = &pixels[MIN(MAX(y - e->y, 0), e->height - 1) * e->width * bpp];
+		unsigned char		*dest = &page[(size_t)y * width * bpp];
+
+		for (int x = x0; x < e->x; x++)
+			memcpy(&dest[x * bpp], src, bpp);
+
+		memcpy(&dest[e->x * bpp], src, e->width * bpp);
+
+		for (int x = e->x + e->width; x < x1; x++)
+			memcpy(&dest[x * bpp], &src[(e->width - 1) * bpp], bpp);
+	}
+}
+
+
+/* pack the added textures into pages and tex_place() them there, the ones
+ * too big for a page are left alone.  The pages are only referenced by the
+ * placed textures, the atlas may be freed right after.
+ */
+void tex_atlas_pack(tex_atlas_t *atlas, tex_atlas_stats_t *res_stats)
+{
+	size_t		bpp, used = 0, total = 0;
+	int		max_size, size;
+	unsigned	n_pages;
+
+	assert(atlas);
+	assert(res_stats);
+
+	bpp = atlas->indexed ? 1 : 4;
+
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+	size = MIN(TEX_ATLAS_SIZE, max_size);
+
+	n_pages = tex_atlas_place(atlas, size);
+	*res_stats = (tex_atlas_stats_t){ .n_pages = n_pages, .page_size = size };
+
+	for (int p = 0; p < (int)n_pages; p++) {
+		int		height = TEX_ATLAS_ALIGN;
+		unsigned char	*buf;
+		tex_t		*page;
+
+		/* trim the page to a power of two past its lowest shelf */
+		for (unsigned i = 0; i < atlas->n_entries; i++) {
+			if (atlas->entries[i].page == p)
+				height = MAX(height, atlas->entries[i].y + atlas->entries[i].height + TEX_ATLAS_EXTRUDE);
+		}
+
+		while (height & (height - 1))
+			height += height & -height;
+
+		buf = malloc(size * height * bpp);
+		fatal_if(!buf, "unable to allocate %ix%i atlas page", size, height);
+		memset(buf, atlas->indexed ? ANSR_VIEW_TRANSPARENT : 0, size * height * bpp);
+
+		for (unsigned i = 0; i < atlas->n_entries; i++) {
+			tex_atlas_entry_t	*e = &atlas->entries[i];
+
+			if (e->page != p)
+				continue;
+
+			tex_atlas_blit(e, buf, size, height, bpp);
+		}
+
+		if (atlas->indexed)
+			page = tex_new_indexed(size, height, buf);
+		else
+			page = tex_new(size, height, buf);
+		fatal_if(!page, "unable to create atlas page");
+		free(buf);
+
+		for (unsigned i = 0; i < atlas->n_entries; i++) {
+			tex_atlas_entry_t	*e = &atlas->entries[i];
+
+			if (e->page != p)
+				continue;
+
+			tex_place(e->tex, page, &(bb2f_t){
+							.min = { (float)e->x / size, (float)e->y / height },
+							.max = { (float)(e->x + e->width) / size, (float)(e->y + e->height) / height },
+						});
+			used += (size_t)e->width * e->height;
+			res_stats->n_packed++;
+		}
+
+		tex_free(page);
+		total += (size_t)size * height;
+	}
+
+	res_stats->n_standalone = atlas->n_entries - res_stats->n_packed;
+	res_stats->occupancy = total ? (float)used / total : 0.f;
+}
+
+
+/* did tex_atlas_pack() place tex in a page?  0 for the standalone ones */
+int tex_atlas_packed(const tex_atlas_t *atlas, const tex_t *tex)
+{
+	assert(atlas);
+	assert(tex);
+
+	for (unsigned i = 0; i < atlas->n_entries; i++) {
+		if (atlas->entries[i].tex == tex)
+			return atlas->entries[i].page != -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TEX_ATLAS_H
+#define _TEX_ATLAS_H
+
+typedef struct tex_atlas_t tex_atlas_t;
+typedef struct tex_t tex_t;
+
+typedef struct tex_atlas_stats_t {
+	unsigned	n_pages;
+	unsigned	n_packed;	/* textures placed in the pages */
+	unsigned	n_standalone;	/* textures too big for a page, left as-is */
+	unsigned	page_size;	/* width and maximum height of the pages */
+	float		occupancy;	/* fraction of the pages' texels used by the packed textures */
+} tex_atlas_stats_t;
+
+tex_atlas_t * tex_atlas_new(int indexed);
+tex_atlas_t * tex_atlas_free(tex_atlas_t *atlas);
+void tex_atlas_add(tex_atlas_t *atlas, tex_t *tex, int width, int height, const void *pixels);
+void tex_atlas_pack(tex_atlas_t *atlas, tex_atlas_stats_t *res_stats);
+int tex_atlas_packed(const tex_atlas_t *atlas, const tex_t *tex);
+
+#endif
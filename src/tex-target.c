@@ -0,0 +1,257 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A texture for rendering into instead of the framebuffer, sized to some
+ * fraction of the viewport, which then gets drawn over the whole viewport w/
+ * bilinear filtering.  Rendering between tex_target_begin() and _end() goes
+ * into the texture w/the viewport scaled down to its size, so whatever draws
+ * in normalized device coordinates doesn't need to know about it.
+ *
+ * The texture may also cover just some bounds of the viewport, see
+ * tex_target_fit_bounds(), then the viewport gets offset so those bounds land
+ * in the texture and only they get drawn over.
+ *
+ * What's rendered in there has premultiplied alpha, see gl_state_blend().
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "bb2f.h"
+#include "gl-state.h"
+#include "glad.h"
+#include "m4f.h"
+#include "m4f-3dx.h"
+#include "macros.h"
+#include "tex.h"
+#include "tex-target.h"
+
+struct tex_target_t {
+	tex_t		*tex;
+	unsigned	fbo;
+	int		width, height;	/* of tex, 0 until tex_target_fit() */
+	int		x, y;		/* of tex within the scaled viewport */
+	int		view_width, view_height;	/* the scaled viewport */
+
+	/* what tex_target_begin() put aside for tex_target_end() */
+	GLint		framebuffer, viewport[4];
+	GLfloat		clear[4];
+};
+
+
+tex_target_t * tex_target_new(void)
+{
+	tex_target_t	*target;
+
+	target = calloc(1, sizeof(tex_target_t));
+	fatal_if(!target, "Unable to allocate tex_target_t");
+
+	return target;
+}
+
+
+tex_target_t * tex_target_free(tex_target_t *target)
+{
+	if (!target)
+		return NULL;
+
+	tex_free(target->tex);
+	if (target->fbo)
+		glDeleteFramebuffers(1, &target->fbo);
+	free(target);
+
+	return NULL;
+}
+
+
+/* the pixel normalized device coordinate v falls in, along a view_size axis */
+static inline int tex_target_pixel(float v, int view_size)
+{
+	return (int)floorf((MIN(MAX(v, -1.f), 1.f) * .5f + .5f) * view_size);
+}
+
+
+/* find the pixels of a view_width x view_height viewport covering bounds, which
+ * are kept at least a pixel even when entirely offscreen or empty.
+ */
+static void tex_target_pixels(int view_width, int view_height, const bb2f_t *bounds, int *res_x0, int *res_y0, int *res_x1, int *res_y1)
+{
+	*res_x0 = MIN(tex_target_pixel(bounds->min.x, view_width), view_width - 1);
+	*res_y0 = MIN(tex_target_pixel(bounds->min.y, view_height), view_height - 1);
+
+	/* the max rounded up, by rounding down the negated max */
+	*res_x1 = MAX(-tex_target_pixel(-bounds->max.x, view_width) + view_width, *res_x0 + 1);
+	*res_y1 = MAX(-tex_target_pixel(-bounds->max.y, view_height) + view_height, *res_y0 + 1);
+}
+
+
+/* like tex_target_fit(), but only covering bounds of the viewport in normalized
+ * device coordinates rounded out to whole pixels, or all of it when NULL.
+ * Anything rendered outside of them gets clipped.  Returns nonzero when that
+ * took a new texture or moved the bounds, w/nothing rendered for them yet.
+ */
+int tex_target_fit_bounds(tex_target_t *target, float scale, const bb2f_t *bounds)
+{
+	GLint		viewport[4], framebuffer;
+	int		view_width, view_height, x0 = 0, y0 = 0, x1, y1, width, height, moved;
+	unsigned	name;
+
+	assert(target);
+	assert(scale > 0.f);
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	view_width = x1 = MAX((int)(viewport[2] * scale + .5f), 1);
+	view_height = y1 = MAX((int)(viewport[3] * scale + .5f), 1);
+
+	if (bounds)
+		tex_target_pixels(view_width, view_height, bounds, &x0, &y0, &x1, &y1);
+
+	moved = (x0 != target->x || y0 != target->y || view_width != target->view_width || view_height != target->view_height);
+	target->x = x0;
+	target->y = y0;
+	target->view_width = view_width;
+	target->view_height = view_height;
+
+	width = x1 - x0;
+	height = y1 - y0;
+	if (width == target->width && height == target->height)
+		return moved;
+
+	target->tex = tex_free(target->tex);
+
+	glGenTextures(1, &name);
+	gl_state_bind_texture(0, name);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	target->tex = tex_new_premultiplied_uploaded(name, width, height);
+
+	if (!target->fbo)
+		glGenFramebuffers(1, &target->fbo);
+
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, name, 0);
+	fatal_if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE,
+		"Unable to render into a %ix%i texture", width, height);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	target->width = width;
+	target->height = height;
+
+	return 1;
+}
+
+
+/* size target to scale of the current viewport, returns nonzero when that
+ * took a new texture, w/nothing rendered in it yet.
+ */
+int tex_target_fit(tex_target_t *target, float scale)
+{
+	return tex_target_fit_bounds(target, scale, NULL);
+}
+
+
+/* check if target's pixels cover bounds in normalized device coordinates */
+int tex_target_covers(const tex_target_t *target, const bb2f_t *bounds)
+{
+	int	x0, y0, x1, y1;
+
+	assert(target);
+	assert(bounds);
+
+	tex_target_pixels(target->view_width, target->view_height, bounds, &x0, &y0, &x1, &y1);
+
+	return (x0 >= target->x && y0 >= target->y &&
+		x1 <= target->x + target->width && y1 <= target->y + target->height);
+}
+
+
+/* get the bounds of the viewport target covers from tex_target_fit_bounds(),
+ * in normalized device coordinates.
+ */
+void tex_target_bounds(const tex_target_t *target, bb2f_t *res_bounds)
+{
+	assert(target);
+	assert(target->tex);
+	assert(res_bounds);
+
+	*res_bounds = (bb2f_t){
+			.min = {
+				.x = target->x * 2.f / target->view_width - 1.f,
+				.y = target->y * 2.f / target->view_height - 1.f,
+			},
+			.max = {
+				.x = (target->x + target->width) * 2.f / target->view_width - 1.f,
+				.y = (target->y + target->height) * 2.f / target->view_height - 1.f,
+			},
+		};
+}
+
+
+/* start rendering into target, cleared to transparent black */
+void tex_target_begin(tex_target_t *target)
+{
+	assert(target);
+	assert(target->tex);
+
+	/* whatever's queued belongs to the framebuffer we're leaving */
+	tex_flush();
+
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target->framebuffer);
+	glGetIntegerv(GL_VIEWPORT, target->viewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, target->clear);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+	glViewport(-target->x, -target->y, target->view_width, target->view_height);
+	glClearColor(0.f, 0.f, 0.f, 0.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+}
+
+
+/* go back to rendering wherever we were before tex_target_begin() */
+void tex_target_end(tex_target_t *target)
+{
+	assert(target);
+
+	tex_flush();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+	glViewport(target->viewport[0], target->viewport[1], target->viewport[2], target->viewport[3]);
+	glClearColor(target->clear[0], target->clear[1], target->clear[2], target->clear[3]);
+}
+
+
+/* draw what's been rendered into target over the viewport bounds it covers */
+void tex_target_render(tex_target_t *target, float alpha)
+{
+	m4f_t	identity = m4f_identity();
+	m4f_t	model_x;
+	bb2f_t	bounds;
+
+	assert(target);
+	assert(target->tex);
+
+	tex_target_bounds(target, &bounds);
+
+	/* the texture's rows are bottom up */
+	model_x = m4f_translate(NULL, &(v3f_t){ (bounds.min.x + bounds.max.x) * .5f, (bounds.min.y + bounds.max.y) * .5f, 0.f });
+	model_x = m4f_scale(&model_x, &(v3f_t){ (bounds.max.x - bounds.min.x) * .5f, (bounds.min.y - bounds.max.y) * .5f, 1.f });
+	tex_render(target->tex, alpha, &identity, &model_x);
+}
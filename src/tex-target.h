@@ -0,0 +1,33 @@
+/*
+ *  Copyright (C) 2026 - Vito Caputo - <vcaputo@pengaru.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License version 3 as published
+ *  by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TEX_TARGET_H
+#define _TEX_TARGET_H
+
+typedef struct bb2f_t bb2f_t;
+typedef struct tex_target_t tex_target_t;
+
+tex_target_t * tex_target_new(void);
+tex_target_t * tex_target_free(tex_target_t *target);
+int tex_target_fit_bounds(tex_target_t *target, float scale, const bb2f_t *bounds);
+int tex_target_fit(tex_target_t *target, float scale);
+int tex_target_covers(const tex_target_t *target, const bb2f_t *bounds);
+void tex_target_bounds(const tex_target_t *target, bb2f_t *res_bounds);
+void tex_target_begin(tex_target_t *target);
+void tex_target_end(tex_target_t *target);
+void tex_target_render(tex_target_t *target, float alpha);
+
+#endif
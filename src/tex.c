@@ -15,21 +15,85 @@
  */
 
 #include <assert.h>
+#include <math.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "ansr-view.h"
+#include "bb2f.h"
+#include "cp437-bits.h"
+#include "gl-ext.h"
+#include "gl-state.h"
 #include "glad.h"
 #include "m4f.h"
 #include "macros.h"
 #include "shader.h"
 #include "tex.h"
+#include "v4f.h"
+
+/* the palette of indexed and cells textures, ansr_view_palette[] + ANSR_VIEW_TRANSPARENT */
+#define TEX_PALETTE_SIZE	17
+
+/* sprites queued by tex_render() before they get drawn, see tex_flush() */
+#define TEX_BATCH_SPRITES	256
+
+/* fewer instances than this are cheaper queued w/the neighboring sprites than
+ * drawn on their own, see tex_render_instances()
+ */
+#define TEX_INSTANCES_MIN	8
 
 typedef struct tex_t {
 	unsigned	tex;
 	unsigned	refcnt;
+	int		width, height;	/* in cells when cells */
+	unsigned	lod;		/* full size levels skipped, see tex_upload_lod() */
+	bb2f_t		bounds;		/* drawn part of the -1..+1 quad, see tex_set_bounds() */
+	bb2f_t		opaque;		/* opaque part of the -1..+1 quad, see tex_set_opaque() */
+	tex_t		*page;		/* texture holding the texels when placed in an atlas page */
+	bb2f_t		uv;		/* texcoords of the texels within tex or page */
+	size_t		size;		/* bytes of texture memory */
+	unsigned	cells:1;	/* an ansr_cells_t grid, see tex_new_cells() */
+	unsigned	indexed:1;	/* palette indices, see tex_new_indexed() */
+	unsigned	premultiplied:1;	/* RGBA w/alpha premultiplied, see tex_new_premultiplied_uploaded() */
 } tex_t;
 
-static unsigned	vbo, tcbo;
-static shader_t	*tex_shader;
+/* tex_render() transforms the sprite's quad on the CPU, so sprites sharing
+ * texels can be drawn together regardless of their transforms and alpha.
+ */
+typedef struct tex_vertex_t {
+	v4f_t		position;	/* clip space */
+	float		s, t;
+	float		alpha;
+} tex_vertex_t;
+
+static struct {
+	tex_t		*texels;	/* texture being batched, NULL when empty */
+	unsigned	n_sprites;
+	unsigned	draws, sprites;	/* totals, see tex_draw_stats() */
+	tex_vertex_t	vertices[TEX_BATCH_SPRITES * 6];
+} tex_batch;
+
+static unsigned	vbo;	/* streams tex_batch.vertices */
+static shader_t	*tex_shader, *cells_shader, *indexed_shader, *premultiplied_shader;
+static gl_state_vertex_array_t	tex_array, cells_array, indexed_array, premultiplied_array;	/* vbo for each shader's attributes */
+
+/* tex_render_instances() w/instanced arrays draws the quad from quad_vbo once
+ * per tex_instance_t in instances_vbo, w/these programs for RGBA, cells,
+ * indexed and premultiplied textures respectively.
+ */
+typedef struct tex_instanced_t {
+	shader_t		*shader;
+	gl_state_vertex_array_t	array;
+} tex_instanced_t;
+
+static tex_instanced_t	tex_instanced[4];
+static unsigned	quad_vbo, instances_vbo;
+static unsigned	cells_font;	/* shared by all cells textures */
+static unsigned	tex_palette;	/* TEX_PALETTE_SIZE x 1, shared by cells and indexed textures */
+static size_t	tex_resident;	/* bytes of texture memory held by live tex_t */
+static unsigned	tex_reuploaded;	/* times tex_reupload() replaced texels, see tex_reuploads() */
+static bb2f_t	*tex_extents;	/* grown by whatever gets drawn, see tex_track_extents() */
 
 static const float	vertices[] = {
 	+1.f, +1.f, 0.f,
@@ -40,16 +104,6 @@ static const float	vertices[] = {
 	-1.f, +1.f, 0.f,
 };
 
-static const float	texcoords[] = {
-	1.f, 0.f,
-	1.f, 1.f,
-	0.f, 0.f,
-	1.f, 1.f,
-	0.f, 1.f,
-	0.f, 0.f,
-};
-
-
 static const char	*tex_vs = ""
 #ifdef __EMSCRIPTEN__
 	"#version 100\n"
@@ -57,14 +111,13 @@ static const char	*tex_vs = ""
 	"#version 120\n"
 #endif
 
-	"uniform mat4	model_x;"
-	"uniform mat4	projection_x;"
-
-	"attribute vec3	vertex;"
-	"attribute vec2	texcoord;"
+	"attribute vec4		vertex;"	/* already transformed, see tex_render() */
+	"attribute vec2		texcoord;"
+	"attribute float	opacity;"
 
+	"varying float		ALPHA;"
 #ifdef __EMSCRIPTEN__
-	"varying vec2 UV;"
+	"varying vec2		UV;"
 #endif
 
 	"void main()"
@@ -74,7 +127,56 @@ static const char	*tex_vs = ""
 #else
 	"	gl_TexCoord[0].xy = texcoord;"
 #endif
-	"	gl_Position = projection_x * model_x * vec4(vertex, 1.0);"
+	"	ALPHA = opacity;"
+	"	gl_Position = vertex;"
+	"}"
+"";
+
+
+/* places the -1..+1 quad per tex_instance_t at time, the same as tex_render()
+ * would w/the model_x of tex_instance_at().  The fragment shaders are shared
+ * w/tex_vs.
+ */
+static const char	*tex_instanced_vs = ""
+#ifdef __EMSCRIPTEN__
+	"#version 100\n"
+#else
+	"#version 120\n"
+#endif
+
+	"attribute vec2		corner;"	/* of the -1..+1 quad */
+	"attribute vec4		placement;"	/* position.xy, scale.xy */
+	"attribute vec4		spin;"		/* rotation, alpha, swing, fade */
+	"attribute vec4		motion;"	/* velocity.xy, wrap.xy */
+	"attribute vec4		wave;"		/* sway.xy, rate, phase */
+
+	"uniform mat4		projection_x;"
+	"uniform vec4		bounds;"	/* see tex_set_bounds(), min.xy, max.xy */
+	"uniform vec4		uv;"		/* texcoords of the texels, min.st, max.st */
+	"uniform float		alpha;"
+	"uniform float		time;"
+
+	"varying float		ALPHA;"
+#ifdef __EMSCRIPTEN__
+	"varying vec2		UV;"
+#endif
+
+	"void main()"
+	"{"
+	"	vec2	p = mix(bounds.xy, bounds.zw, corner * .5 + .5);"
+	"	float	w = sin(time * wave.z + wave.w);"
+	"	vec2	position = placement.xy + motion.xy * time + wave.xy * (time * w);"
+	"	float	c = cos(spin.x + spin.z * w), s = sin(spin.x + spin.z * w);"
+
+	"	position = mix(position, mod(position + motion.zw, max(motion.zw * 2., 1e-6)) - motion.zw, step(1e-6, motion.zw));"
+
+#ifdef __EMSCRIPTEN__
+	"	UV = mix(uv.xy, uv.zw, vec2(p.x * .5 + .5, .5 - p.y * .5));"
+#else
+	"	gl_TexCoord[0].xy = mix(uv.xy, uv.zw, vec2(p.x * .5 + .5, .5 - p.y * .5));"
+#endif
+	"	ALPHA = max(spin.y + spin.w * time, 0.) * alpha;"
+	"	gl_Position = projection_x * vec4(position + placement.zw * (mat2(c, s, -s, c) * p), 0., 1.);"
 	"}"
 "";
 
@@ -90,7 +192,7 @@ static const char	*tex_fs = ""
 #endif
 
 	"uniform sampler2D	tex0;"
-	"uniform float		alpha;"
+	"varying float		ALPHA;"
 
 	"void main()"
 	"{"
@@ -99,96 +201,1057 @@ static const char	*tex_fs = ""
 #else
 	"	gl_FragColor = texture2D(tex0, gl_TexCoord[0].st);"
 #endif
-	"	gl_FragColor.a *= alpha;"
+	"	gl_FragColor.a *= ALPHA;"
 	"}"
 "";
 
 
-/* Render simply renders a texd texture onto the screen */
+/* Cells textures hold a texel per character cell instead of pixels, see
+ * ansr_cells_t, and this reconstructs the pixels from the cp437 font and VGA
+ * palette textures on units 1 and 2.  The cell and glyph coordinates need
+ * more precision than mediump guarantees for the larger sprites.
+ */
+static const char	*cells_fs = ""
+#ifdef __EMSCRIPTEN__
+	"#version 100\n"
+
+	"#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+	"precision highp float;\n"
+	"#else\n"
+	"precision mediump float;\n"
+	"#endif\n"
+	"varying vec2		UV;"
+#else
+	"#version 120\n"
+#endif
+
+	"uniform sampler2D	cells;"
+	"uniform sampler2D	font;"		/* 16x16 glyphs of 8x16 */
+	"uniform sampler2D	palette;"	/* 17x1 */
+	"uniform vec2		grid;"		/* cells width, height */
+	"varying float		ALPHA;"
+
+	"float glyph(float code, vec2 px)"
+	"{"
+	"	vec2	at = vec2(mod(code, 16.), floor(code / 16.)) * vec2(8., 16.) + px + .5;"
+
+	"	return texture2D(font, at / vec2(128., 256.)).r;"
+	"}"
+
+	"void main()"
+	"{"
+#ifdef __EMSCRIPTEN__
+	"	vec2	pos = min(UV * grid, grid - vec2(.5 / 8., .5 / 16.));"
+#else
+	"	vec2	pos = min(gl_TexCoord[0].st * grid, grid - vec2(.5 / 8., .5 / 16.));"
+#endif
+	"	vec2	cell = floor(pos);"
+	"	vec2	px = floor(fract(pos) * vec2(8., 16.));"
+	"	vec4	c = floor(texture2D(cells, (cell + .5) / grid) * 255. + .5);"
+	"	float	fg = mod(c.g, 16.), bg = floor(c.g / 16.);"
+	"	float	cover = glyph(c.b, px) > .5 ? mod(c.a, 2.) : mod(floor(c.a / 2.), 2.);"
+	"	vec4	color = texture2D(palette, vec2(((glyph(c.r, px) > .5 ? fg : bg) + .5) / 17., .5));"
+
+	"	gl_FragColor = vec4(color.rgb, cover * ALPHA);"
+	"}"
+"";
+
+
+/* Indexed textures hold a byte per pixel indexing the palette on unit 2,
+ * which has to be looked up before filtering.  So this samples the four
+ * nearest indices itself and does what GL_LINEAR would've done with the
+ * looked up colors, clamping to the edge just the same.
+ */
+static const char	*indexed_fs = ""
+#ifdef __EMSCRIPTEN__
+	"#version 100\n"
+
+	"#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+	"precision highp float;\n"
+	"#else\n"
+	"precision mediump float;\n"
+	"#endif\n"
+	"varying vec2		UV;"
+#else
+	"#version 120\n"
+#endif
+
+	"uniform sampler2D	tex0;"
+	"uniform sampler2D	palette;"	/* 17x1 */
+	"uniform vec2		size;"		/* tex0 width, height */
+	"varying float		ALPHA;"
+
+	"vec4 lookup(vec2 texel)"
+	"{"
+	"	float	i = floor(texture2D(tex0, (clamp(texel, vec2(0.), size - 1.) + .5) / size).r * 255. + .5);"
+
+	"	return texture2D(palette, vec2((i + .5) / 17., .5));"
+	"}"
+
+	"void main()"
+	"{"
+#ifdef __EMSCRIPTEN__
+	"	vec2	pos = UV * size - .5;"
+#else
+	"	vec2	pos = gl_TexCoord[0].st * size - .5;"
+#endif
+	"	vec2	base = floor(pos), f = pos - base;"
+
+	"	gl_FragColor = mix(mix(lookup(base), lookup(base + vec2(1., 0.)), f.x),"
+	"			   mix(lookup(base + vec2(0., 1.)), lookup(base + vec2(1., 1.)), f.x), f.y);"
+	"	gl_FragColor.a *= ALPHA;"
+	"}"
+"";
+
+
+/* Premultiplied textures already have their alpha applied to the color, like
+ * what got rendered into one w/gl_state_blend(), so the alpha applies to all of it.
+ */
+static const char	*premultiplied_fs = ""
+#ifdef __EMSCRIPTEN__
+	"#version 100\n"
+
+	"precision mediump float;"
+	"varying vec2		UV;"
+#else
+	"#version 120\n"
+#endif
+
+	"uniform sampler2D	tex0;"
+	"varying float		ALPHA;"
+
+	"void main()"
+	"{"
+#ifdef __EMSCRIPTEN__
+	"	gl_FragColor = texture2D(tex0, UV) * ALPHA;"
+#else
+	"	gl_FragColor = texture2D(tex0, gl_TexCoord[0].st) * ALPHA;"
+#endif
+	"}"
+"";
+
+
+/* bind texels and whatever else drawing them needs */
+static void tex_bind_texels(const tex_t *texels)
+{
+	if (texels->cells)
+		gl_state_bind_texture(1, cells_font);
+
+	if (texels->cells || texels->indexed)
+		gl_state_bind_texture(2, tex_palette);
+
+	gl_state_bind_texture(0, texels->tex);
+	gl_state_blend(texels->premultiplied ? GL_ONE : GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+
+/* draw whatever tex_render() queued, in one draw call */
+void tex_flush(void)
+{
+	tex_t			*texels = tex_batch.texels;
+	shader_t		*shader = tex_shader;
+	gl_state_vertex_array_t	*array = &tex_array;
+	int			*uniforms, *attributes;
+
+	tex_batch.texels = NULL;
+	if (!tex_batch.n_sprites)
+		return;
+
+	if (texels->cells) {
+		shader = cells_shader;
+		array = &cells_array;
+	} else if (texels->indexed) {
+		shader = indexed_shader;
+		array = &indexed_array;
+	} else if (texels->premultiplied) {
+		shader = premultiplied_shader;
+		array = &premultiplied_array;
+	}
+
+	shader_use(shader, NULL, &uniforms, NULL, &attributes);
+
+	/* the shaders' attribute locations may differ, so each gets its own array */
+	if (!array->buffer) {
+		*array = (gl_state_vertex_array_t){
+				.buffer = vbo,
+				.stride = sizeof(tex_vertex_t),
+				.n_attributes = 3,
+				.attributes = {
+					{ attributes[0], 4, offsetof(tex_vertex_t, position) },
+					{ attributes[1], 2, offsetof(tex_vertex_t, s) },
+					{ attributes[2], 1, offsetof(tex_vertex_t, alpha) },
+				},
+			};
+	}
+
+	/* orphan the last batch's storage rather than waiting on its draw */
+	gl_state_bind_array_buffer(vbo);
+	glBufferData(GL_ARRAY_BUFFER, tex_batch.n_sprites * 6 * sizeof(tex_vertex_t), tex_batch.vertices, GL_STREAM_DRAW);
+	gl_state_bind_vertex_array(array);
+
+	tex_bind_texels(texels);
+	if (texels->cells || texels->indexed)
+		glUniform2f(uniforms[0], texels->width, texels->height);
+
+	glDrawArrays(GL_TRIANGLES, 0, tex_batch.n_sprites * 6);
+
+	tex_batch.draws++;
+	tex_batch.sprites += tex_batch.n_sprites;
+	tex_batch.n_sprites = 0;
+}
+
+
+/* grow tex_extents by tex's quad transformed by x */
+static void tex_extend(const tex_t *tex, const m4f_t *x)
+{
+	v4f_t	corners[4] = {
+			{ tex->bounds.min.x, tex->bounds.min.y, 0.f, 1.f },
+			{ tex->bounds.min.x, tex->bounds.max.y, 0.f, 1.f },
+			{ tex->bounds.max.x, tex->bounds.min.y, 0.f, 1.f },
+			{ tex->bounds.max.x, tex->bounds.max.y, 0.f, 1.f },
+		};
+
+	for (int i = 0; i < NELEMS(corners); i++) {
+		v4f_t	p = m4f_mult_v4f(x, &corners[i]);
+
+		tex_extents->min.x = MIN(tex_extents->min.x, p.x);
+		tex_extents->min.y = MIN(tex_extents->min.y, p.y);
+		tex_extents->max.x = MAX(tex_extents->max.x, p.x);
+		tex_extents->max.y = MAX(tex_extents->max.y, p.y);
+	}
+}
+
+
+/* queue tex's quad transformed by x for tex_flush() */
+static void tex_queue(tex_t *tex, float alpha, const m4f_t *x)
+{
+	tex_t		*texels = tex->page ? tex->page : tex;
+	tex_vertex_t	*v;
+
+	if (texels != tex_batch.texels || tex_batch.n_sprites == TEX_BATCH_SPRITES) {
+		tex_flush();
+		tex_batch.texels = texels;
+	}
+
+	v = &tex_batch.vertices[tex_batch.n_sprites * 6];
+	for (int i = 0; i < 6; i++) {
+		float	px = tex->bounds.min.x + (tex->bounds.max.x - tex->bounds.min.x) * (vertices[i * 3] * .5f + .5f);
+		float	py = tex->bounds.min.y + (tex->bounds.max.y - tex->bounds.min.y) * (vertices[i * 3 + 1] * .5f + .5f);
+
+		v[i].position = m4f_mult_v4f(x, &(v4f_t){ px, py, vertices[i * 3 + 2], 1.f });
+		v[i].s = tex->uv.min.x + (tex->uv.max.x - tex->uv.min.x) * (px * .5f + .5f);
+		v[i].t = tex->uv.min.y + (tex->uv.max.y - tex->uv.min.y) * (.5f - py * .5f);
+		v[i].alpha = alpha;
+	}
+	tex_batch.n_sprites++;
+
+	if (tex_extents)
+		tex_extend(tex, x);
+}
+
+
+/* Queues tex for drawing onto the screen, consecutive sprites sharing the
+ * same texels (like ones packed in the same atlas page) get drawn together.
+ * Anything drawing w/GL directly must tex_flush() first to keep the order.
+ */
 void tex_render(tex_t *tex, float alpha, m4f_t *projection_x, m4f_t *model_x)
 {
-	int		*uniforms, *attributes;
+	m4f_t	x;
 
 	assert(tex);
 	assert(projection_x);
 	assert(model_x);
 
-	shader_use(tex_shader, NULL, &uniforms, NULL, &attributes);
+	x = m4f_mult(projection_x, model_x);
+	tex_queue(tex, alpha, &x);
+}
+
 
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glVertexAttribPointer(attributes[0], 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(attributes[0]);
+/* setup the instanced program for a kind of texels, see tex_instanced_program().
+ * These get created along w/the kind's other shader rather than on their first
+ * draw, so shader_warmup() sees them.
+ */
+static void tex_instanced_init(unsigned kind)
+{
+	const char		*fs[] = { tex_fs, cells_fs, indexed_fs, premultiplied_fs };
+	int			*uniforms;
 
-	glBindBuffer(GL_ARRAY_BUFFER, tcbo);
-	glVertexAttribPointer(attributes[1], 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-	glEnableVertexAttribArray(attributes[1]);
+	assert(kind < NELEMS(tex_instanced));
 
-	glBindTexture(GL_TEXTURE_2D, tex->tex);
+	if (!gl_ext.instanced_arrays || tex_instanced[kind].shader)
+		return;
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	if (!quad_vbo) {
+		glGenBuffers(1, &quad_vbo);
+		gl_state_bind_array_buffer(quad_vbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-	glUniform1f(uniforms[0], alpha);
-	glUniformMatrix4fv(uniforms[1], 1, GL_FALSE, &projection_x->m[0][0]);
-	glUniformMatrix4fv(uniforms[2], 1, GL_FALSE, &model_x->m[0][0]);
+		glGenBuffers(1, &instances_vbo);
+	}
 
-	glDrawArrays(GL_TRIANGLES, 0, 6);
+	/* the uniforms of every kind, the ones absent from a kind's shader are just -1 */
+	tex_instanced[kind].shader = shader_pair_new(tex_instanced_vs, fs[kind],
+						11,
+						(const char *[]) {
+							"projection_x",
+							"bounds",
+							"uv",
+							"alpha",
+							"grid",
+							"size",
+							"tex0",
+							"cells",
+							"font",
+							"palette",
+							"time",
+						},
+						5,
+						(const char *[]) {
+							"corner",
+							"placement",
+							"spin",
+							"motion",
+							"wave",
+						});
 
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glUseProgram(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	shader_use(tex_instanced[kind].shader, NULL, &uniforms, NULL, NULL);
+	glUniform1i(uniforms[6], 0);
+	glUniform1i(uniforms[7], 0);
+	glUniform1i(uniforms[8], 1);
+	glUniform1i(uniforms[9], 2);
 }
 
 
-tex_t * tex_new(int width, int height, const unsigned char *buf)
+/* get the instanced program for texels' kind */
+static tex_instanced_t * tex_instanced_program(const tex_t *texels)
 {
-	tex_t	*tex;
+	unsigned	kind = texels->cells ? 1 : texels->indexed ? 2 : texels->premultiplied ? 3 : 0;
 
-	assert(buf);
+	assert(tex_instanced[kind].shader);
+
+	return &tex_instanced[kind];
+}
+
+
+/* where instance is at time, as a model_x for tex_render() and its alpha,
+ * this must agree w/tex_instanced_vs.
+ */
+static void tex_instance_at(const tex_instance_t *instance, float time, m4f_t *res_model_x, float *res_alpha)
+{
+	float	w = sinf(time * instance->rate + instance->phase);
+	float	r = instance->rotation + instance->swing * w, c = cosf(r), s = sinf(r);
+	v2f_t	p = {
+			.x = instance->position.x + instance->velocity.x * time + instance->sway.x * time * w,
+			.y = instance->position.y + instance->velocity.y * time + instance->sway.y * time * w,
+		};
+
+	if (instance->wrap.x > 0.f)
+		p.x -= floorf((p.x + instance->wrap.x) / (instance->wrap.x * 2.f)) * instance->wrap.x * 2.f;
+
+	if (instance->wrap.y > 0.f)
+		p.y -= floorf((p.y + instance->wrap.y) / (instance->wrap.y * 2.f)) * instance->wrap.y * 2.f;
+
+	*res_model_x = (m4f_t){ .m = {
+				{ instance->scale.x * c, instance->scale.y * s, 0.f, 0.f },
+				{ -instance->scale.x * s, instance->scale.y * c, 0.f, 0.f },
+				{ 0.f, 0.f, 1.f, 0.f },
+				{ p.x, p.y, 0.f, 1.f },
+			}};
+	*res_alpha = MAX(instance->alpha + instance->fade * time, 0.f);
+}
+
+
+/* Draws tex once per instance at time, each placed like tex_render() w/a
+ * model_x of translate(position) * scale(scale) * rotate(rotation around z)
+ * after applying the instance's motion, see tex_instance_t.  This takes a
+ * single instanced draw call when supported, and time is all that needs to
+ * change for animating the instances.  Otherwise the instances are transformed
+ * on the CPU and batched like tex_render() does.  projection_version is for
+ * gl_state_uniform_m4f().
+ */
+void tex_render_instances(tex_t *tex, float alpha, m4f_t *projection_x, unsigned projection_version, float time, unsigned n_instances, const tex_instance_t *instances)
+{
+	tex_instanced_t	*program;
+	tex_t		*texels;
+	int		*uniforms, *attributes;
+
+	assert(tex);
+	assert(projection_x);
+	assert(instances || !n_instances);
+
+	if (!n_instances)
+		return;
+
+	if (!gl_ext.instanced_arrays || n_instances < TEX_INSTANCES_MIN) {
+		for (unsigned i = 0; i < n_instances; i++) {
+			m4f_t	x, model_x;
+			float	a;
+
+			tex_instance_at(&instances[i], time, &model_x, &a);
+			x = m4f_mult(projection_x, &model_x);
+			tex_queue(tex, alpha * a, &x);
+		}
+
+		return;
+	}
+
+	/* draw any sprites queued before us first */
+	tex_flush();
+
+	if (tex_extents) {
+		for (unsigned i = 0; i < n_instances; i++) {
+			m4f_t	x, model_x;
+			float	a;
+
+			tex_instance_at(&instances[i], time, &model_x, &a);
+			x = m4f_mult(projection_x, &model_x);
+			tex_extend(tex, &x);
+		}
+	}
+
+	texels = tex->page ? tex->page : tex;
+	program = tex_instanced_program(texels);
+	shader_use(program->shader, NULL, &uniforms, NULL, &attributes);
 
-	if (!vbo) {
-		/* common to all tex instances */
-		tex_shader = shader_pair_new(tex_vs, tex_fs,
-					3,
-					(const char *[]) {
-						"alpha",
-						"projection_x",
-						"model_x",
+	if (!program->array.buffer) {
+		program->array = (gl_state_vertex_array_t){
+					.buffer = quad_vbo,
+					.stride = 3 * sizeof(float),
+					.instance_buffer = instances_vbo,
+					.instance_stride = sizeof(tex_instance_t),
+					.n_attributes = 5,
+					.attributes = {
+						{ attributes[0], 2, 0 },
+						{ attributes[1], 4, offsetof(tex_instance_t, position), 1 },
+						{ attributes[2], 4, offsetof(tex_instance_t, rotation), 1 },
+						{ attributes[3], 4, offsetof(tex_instance_t, velocity), 1 },
+						{ attributes[4], 4, offsetof(tex_instance_t, sway), 1 },
 					},
-					2,
-					(const char *[]) {
-						"vertex",
-						"texcoord",
-					});
-
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+				};
+	}
+
+	gl_state_uniform_m4f(uniforms[0], projection_x, projection_version);
+	glUniform4f(uniforms[1], tex->bounds.min.x, tex->bounds.min.y, tex->bounds.max.x, tex->bounds.max.y);
+	glUniform4f(uniforms[2], tex->uv.min.x, tex->uv.min.y, tex->uv.max.x, tex->uv.max.y);
+	glUniform1f(uniforms[3], alpha);
+	glUniform2f(uniforms[4], texels->width, texels->height);
+	glUniform2f(uniforms[5], texels->width, texels->height);
+	glUniform1f(uniforms[10], time);
+
+	gl_state_bind_array_buffer(instances_vbo);
+	glBufferData(GL_ARRAY_BUFFER, n_instances * sizeof(tex_instance_t), instances, GL_STREAM_DRAW);
+	gl_state_bind_vertex_array(&program->array);
+	tex_bind_texels(texels);
+
+	gl_ext.DrawArraysInstanced(GL_TRIANGLES, 0, 6, n_instances);
+
+	tex_batch.draws++;
+	tex_batch.sprites += n_instances;
+}
+
+
+/* grow *extents by the bounds in normalized device coordinates of everything
+ * drawn from now on, until called again w/NULL.  Start from an empty extents
+ * w/min at FLT_MAX and max at -FLT_MAX.  Returns the extents being grown before.
+ */
+bb2f_t * tex_track_extents(bb2f_t *extents)
+{
+	bb2f_t	*prev = tex_extents;
+
+	tex_extents = extents;
+
+	return prev;
+}
+
+
+/* the number of draw calls tex_flush() and tex_render_instances() made and the sprites they drew, so far */
+void tex_draw_stats(unsigned *res_draws, unsigned *res_sprites)
+{
+	if (res_draws)
+		*res_draws = tex_batch.draws;
+
+	if (res_sprites)
+		*res_sprites = tex_batch.sprites;
+}
+
+
+/* setup the shader shared by all premultiplied textures, see tex_init() */
+static void tex_premultiplied_init(void)
+{
+	if (premultiplied_shader)
+		return;
+
+	premultiplied_shader = shader_pair_new(tex_vs, premultiplied_fs,
+				0,
+				NULL,
+				3,
+				(const char *[]) {
+					"vertex",
+					"texcoord",
+					"opacity",
+				});
+
+	tex_instanced_init(3);
+}
+
+
+/* setup what's common to all tex instances, on first use */
+static void tex_init(void)
+{
+	if (vbo)
+		return;
+
+	tex_shader = shader_pair_new(tex_vs, tex_fs,
+				0,
+				NULL,
+				3,
+				(const char *[]) {
+					"vertex",
+					"texcoord",
+					"opacity",
+				});
+
+	glGenBuffers(1, &vbo);
+
+	tex_instanced_init(0);
+
+	/* only targets rendered into at runtime use this (see tex-target.c), but
+	 * create it w/the rest anyways so shader_warmup() sees it.
+	 */
+	tex_premultiplied_init();
+}
+
+
+/* setup the palette shared by cells and indexed textures, on first use */
+static void tex_palette_init(void)
+{
+	uint32_t	palette[TEX_PALETTE_SIZE] = {};
+
+	if (tex_palette)
+		return;
+
+	memcpy(palette, ansr_view_palette, sizeof(ansr_view_palette));
+
+	glGenTextures(1, &tex_palette);
+	gl_state_bind_texture(2, tex_palette);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEX_PALETTE_SIZE, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, palette);
+}
 
-		glGenBuffers(1, &tcbo);
-		glBindBuffer(GL_ARRAY_BUFFER, tcbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+/* setup the shader and font shared by all cells textures, on first use */
+static void tex_cells_init(void)
+{
+	unsigned char	font[256 * 16 * 8];
+	int		*uniforms;
+
+	if (cells_shader)
+		return;
+
+	cells_shader = shader_pair_new(tex_vs, cells_fs,
+				4,
+				(const char *[]) {
+					"grid",
+					"cells",
+					"font",
+					"palette",
+				},
+				3,
+				(const char *[]) {
+					"vertex",
+					"texcoord",
+					"opacity",
+				});
+
+	shader_use(cells_shader, NULL, &uniforms, NULL, NULL);
+	glUniform1i(uniforms[1], 0);
+	glUniform1i(uniforms[2], 1);
+	glUniform1i(uniforms[3], 2);
+
+	/* cp437_bits laid out as a 16x16 grid of glyphs, a byte per pixel */
+	for (int c = 0; c < 256; c++) {
+		for (int y = 0; y < 16; y++) {
+			for (int x = 0; x < 8; x++)
+				font[((c / 16) * 16 + y) * 128 + (c % 16) * 8 + x] = (cp437_bits[c][y] & (0x80 >> x)) ? 0xff : 0x00;
+		}
 	}
 
-	tex = calloc(1, sizeof(tex_t));
-	fatal_if(!tex, "Unable to allocate tex_t");
+	glGenTextures(1, &cells_font);
+	gl_state_bind_texture(1, cells_font);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, 128, 256, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, font);
+
+	tex_palette_init();
+	tex_instanced_init(1);
+}
+
+
+/* setup the shader shared by all indexed textures, on first use */
+static void tex_indexed_init(void)
+{
+	int	*uniforms;
+
+	if (indexed_shader)
+		return;
+
+	indexed_shader = shader_pair_new(tex_vs, indexed_fs,
+				3,
+				(const char *[]) {
+					"size",
+					"tex0",
+					"palette",
+				},
+				3,
+				(const char *[]) {
+					"vertex",
+					"texcoord",
+					"opacity",
+				});
+
+	shader_use(indexed_shader, NULL, &uniforms, NULL, NULL);
+	glUniform1i(uniforms[1], 0);
+	glUniform1i(uniforms[2], 2);
+
+	tex_palette_init();
+	tex_instanced_init(2);
+}
+
+
+/* halve a width x height RGBA image into dest w/a 2x2 box filter, the colors
+ * weighted by alpha so the transparent black surrounding sprites doesn't darken
+ * their edges.  Odd dimensions round down like GL's mip level sizes do.
+ */
+static void tex_halve(int width, int height, const uint32_t *src, uint32_t *dest)
+{
+	int	dest_width = MAX(width / 2, 1), dest_height = MAX(height / 2, 1);
+
+	for (int y = 0; y < dest_height; y++) {
+		const uint32_t	*row0 = &src[MIN(y * 2, height - 1) * width];
+		const uint32_t	*row1 = &src[MIN(y * 2 + 1, height - 1) * width];
+
+		for (int x = 0; x < dest_width; x++) {
+			uint32_t	p[4] = {
+						row0[MIN(x * 2, width - 1)], row0[MIN(x * 2 + 1, width - 1)],
+						row1[MIN(x * 2, width - 1)], row1[MIN(x * 2 + 1, width - 1)],
+					};
+			unsigned	r = 0, g = 0, b = 0, a = 0;
+
+			for (int i = 0; i < 4; i++) {
+				unsigned	pa = p[i] >> 24;
+
+				r += (p[i] & 0xff) * pa;
+				g += ((p[i] >> 8) & 0xff) * pa;
+				b += ((p[i] >> 16) & 0xff) * pa;
+				a += pa;
+			}
+
+			if (a)
+				dest[y * dest_width + x] = (r + a / 2) / a | (g + a / 2) / a << 8 | (b + a / 2) / a << 16 | (uint32_t)((a + 2) / 4) << 24;
+			else
+				dest[y * dest_width + x] = 0;
+		}
+	}
+}
+
+
+/* can a width x height texture be mipmapped, which GLES2 only does for powers of two */
+static int tex_mipmapped(int width, int height)
+{
+	return gl_ext.npot_mipmap || (!(width & (width - 1)) && !(height & (height - 1)));
+}
+
+
+/* number of levels in a width x height texture's full mip chain */
+static unsigned tex_levels(int width, int height)
+{
+	unsigned	n = 1;
+
+	while (width > 1 || height > 1) {
+		width = MAX(width / 2, 1);
+		height = MAX(height / 2, 1);
+		n++;
+	}
+
+	return n;
+}
+
+
+/* bytes of texture memory occupied by tex_upload_lod(width, height, lod) */
+static size_t tex_lod_size(int width, int height, unsigned lod)
+{
+	unsigned	n = tex_levels(width, height), last;
+	size_t		size = 0;
+
+	lod = MIN(lod, n - 1);
+	last = tex_mipmapped(width, height) ? n - 1 : lod;
+
+	for (unsigned l = 0; l <= last; l++) {
+		if (l >= lod)
+			size += (size_t)width * height * 4;
+
+		width = MAX(width / 2, 1);
+		height = MAX(height / 2, 1);
+	}
+
+	return size;
+}
+
+
+/* create a GL texture object from buf, skipping the first lod levels of its
+ * mip chain for textures which will never be drawn anywhere near full size.
+ * The levels get box filtered here rather than by glGenerateMipmap(), see
+ * tex_halve().  Without mipmapping support (WebGL 1 w/NPOT dimensions) there's
+ * only the one level, but it still gets halved lod times.
+ *
+ * This only touches the texture itself, so it's usable from any thread
+ * having a context current which shares objects with the render context.
+ * The binding it borrows gets put back for gl_state's sake when that's the
+ * render context.
+ */
+unsigned tex_upload_lod(int width, int height, const unsigned char *buf, unsigned lod)
+{
+	const uint32_t	*level = (const uint32_t *)buf;
+	unsigned	name, n, last;
+	uint32_t	*scratch[2];
+	GLint		bound;
+
+	assert(buf);
+
+	n = tex_levels(width, height);
+	lod = MIN(lod, n - 1);
+	last = tex_mipmapped(width, height) ? n - 1 : lod;
 
-	glGenTextures(1, &tex->tex);
-	glBindTexture(GL_TEXTURE_2D, tex->tex);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+	glGenTextures(1, &name);
+	glBindTexture(GL_TEXTURE_2D, name);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, last > lod ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 
 	/* transparent border pixels outside of the texture boundaries, this
 	 * eliminates the spurious fringing on some sprites/positions */
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, buf);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	/* odd levels are halved into scratch[0], even ones into scratch[1] */
+	scratch[0] = scratch[1] = NULL;
+	if (last) {
+		scratch[0] = malloc((size_t)MAX(width / 2, 1) * MAX(height / 2, 1) * sizeof(uint32_t));
+		scratch[1] = malloc((size_t)MAX(width / 4, 1) * MAX(height / 4, 1) * sizeof(uint32_t));
+		fatal_if(!scratch[0] || !scratch[1], "unable to allocate mip levels");
+	}
+
+	for (unsigned l = 0;; l++) {
+		if (l >= lod)
+			glTexImage2D(GL_TEXTURE_2D, l - lod, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level);
+
+		if (l == last)
+			break;
+
+		tex_halve(width, height, level, scratch[l & 1]);
+		level = scratch[l & 1];
+		width = MAX(width / 2, 1);
+		height = MAX(height / 2, 1);
+	}
+
+	free(scratch[0]);
+	free(scratch[1]);
+	glBindTexture(GL_TEXTURE_2D, bound);
+
+	return name;
+}
 
+
+unsigned tex_upload(int width, int height, const unsigned char *buf)
+{
+	return tex_upload_lod(width, height, buf, 0);
+}
+
+
+/* wrap a texture name occupying size bytes in a tex_t, which takes ownership of it */
+static tex_t * tex_wrap(unsigned name, int width, int height, size_t size)
+{
+	tex_t	*tex;
+
+	assert(name);
+
+	tex_init();
+
+	tex = calloc(1, sizeof(tex_t));
+	fatal_if(!tex, "Unable to allocate tex_t");
+
+	tex->tex = name;
 	tex->refcnt = 1;
+	tex->width = width;
+	tex->height = height;
+	tex->bounds = (bb2f_t){ .min = { -1.f, -1.f }, .max = { 1.f, 1.f } };
+	tex->opaque = tex->bounds;
+	tex->uv = (bb2f_t){ .min = { 0.f, 0.f }, .max = { 1.f, 1.f } };
+	tex->size = size;
+	tex_resident += size;
+
+	return tex;
+}
+
+
+/* wrap an already uploaded texture name from tex_upload_lod() in a tex_t, which takes ownership of it */
+tex_t * tex_new_uploaded(unsigned name, int width, int height, unsigned lod)
+{
+	tex_t	*tex;
+
+	tex = tex_wrap(name, width, height, tex_lod_size(width, height, lod));
+	tex->lod = lod;
+
+	return tex;
+}
+
+
+tex_t * tex_new(int width, int height, const unsigned char *buf)
+{
+	assert(buf);
+
+	return tex_new_uploaded(tex_upload(width, height, buf), width, height, 0);
+}
+
+
+/* replace tex's texture w/name, the same pixels already uploaded at a different
+ * lod by tex_upload_lod(), e.g. when the canvas got resized.  tex takes ownership
+ * of name, and everything referencing tex sees the new one.
+ */
+void tex_reupload(tex_t *tex, unsigned name, unsigned lod)
+{
+	assert(tex);
+	assert(name);
+	assert(!tex->cells && !tex->indexed && !tex->page);
+
+	if (tex_batch.texels == tex)
+		tex_flush();
+
+	gl_state_delete_texture(tex->tex);
+	tex_resident -= tex->size;
+	tex_reuploaded++;
+
+	tex->tex = name;
+	tex->lod = lod;
+	tex->size = tex_lod_size(tex->width, tex->height, lod);
+	tex_resident += tex->size;
+}
+
+
+/* move tex's texels to the uv rect of page, an atlas page of the same kind of
+ * texture, dropping its own texture.  Everything referencing tex keeps working,
+ * but now shares texture binds with everything else in page.
+ */
+void tex_place(tex_t *tex, tex_t *page, const bb2f_t *uv)
+{
+	assert(tex);
+	assert(page);
+	assert(uv);
+	assert(!tex->page && !page->page);
+	assert(tex->cells == page->cells && tex->indexed == page->indexed);
+
+	if (tex_batch.texels == tex)
+		tex_flush();
+
+	gl_state_delete_texture(tex->tex);
+	tex->tex = 0;
+	tex_resident -= tex->size;
+	tex->size = 0;
+	tex->lod = 0;
+
+	tex->page = tex_ref(page);
+	tex->uv = *uv;
+}
+
+
+/* get the dimensions tex was created with, in cells for cells textures */
+void tex_size(const tex_t *tex, int *res_width, int *res_height)
+{
+	assert(tex);
+	assert(res_width);
+	assert(res_height);
+
+	*res_width = tex->width;
+	*res_height = tex->height;
+}
+
+
+/* restrict drawing tex to bounds within its -1..+1 quad, y up, like the model_x
+ * transforms see it.  Sprites set this to their opaque part padded by the
+ * filtering's footprint, so the transparent margins don't cost any fill rate.
+ */
+void tex_set_bounds(tex_t *tex, const bb2f_t *bounds)
+{
+	assert(tex);
+	assert(bounds);
+
+	tex->bounds = *bounds;
+}
+
+
+/* get tex's bounds from tex_set_bounds(), the whole quad by default */
+void tex_bounds(const tex_t *tex, bb2f_t *res_bounds)
+{
+	assert(tex);
+	assert(res_bounds);
+
+	*res_bounds = tex->bounds;
+}
+
+
+/* record the opaque part of tex's -1..+1 quad like tex_set_bounds(), for
+ * things like collisions which shouldn't include any padding for drawing.
+ */
+void tex_set_opaque(tex_t *tex, const bb2f_t *opaque)
+{
+	assert(tex);
+	assert(opaque);
+
+	tex->opaque = *opaque;
+}
+
+
+/* get tex's opaque part from tex_set_opaque(), the whole quad by default */
+void tex_opaque(const tex_t *tex, bb2f_t *res_opaque)
+{
+	assert(tex);
+	assert(res_opaque);
+
+	*res_opaque = tex->opaque;
+}
+
+
+/* returns the lod tex was uploaded at */
+unsigned tex_lod(const tex_t *tex)
+{
+	assert(tex);
+
+	return tex->lod;
+}
+
+
+/* create a GL texture object from a width x height ansr_cells_t grid, returning
+ * its name.  Like tex_upload() this is usable from any thread sharing objects.
+ */
+unsigned tex_upload_cells(int width, int height, const uint32_t *cells)
+{
+	unsigned	name;
+	GLint		bound;
+
+	assert(cells);
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+	glGenTextures(1, &name);
+	glBindTexture(GL_TEXTURE_2D, name);
+
+	/* every fragment samples its cell's center, interpolating cells is meaningless */
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, cells);
+	glBindTexture(GL_TEXTURE_2D, bound);
+
+	return name;
+}
+
+
+/* wrap an already uploaded cells texture name in a tex_t, which takes ownership of it */
+tex_t * tex_new_cells_uploaded(unsigned name, int width, int height)
+{
+	tex_t	*tex;
+
+	tex_cells_init();
+
+	tex = tex_wrap(name, width, height, (size_t)width * height * 4);
+	tex->cells = 1;
+
+	return tex;
+}
+
+
+/* create a tex from a width x height ansr_cells_t grid, rendering it reconstructs
+ * the pixels on the GPU.  It occupies 4 bytes per cell instead of per pixel.
+ */
+tex_t * tex_new_cells(int width, int height, const uint32_t *cells)
+{
+	assert(cells);
+
+	return tex_new_cells_uploaded(tex_upload_cells(width, height, cells), width, height);
+}
+
+
+/* create a GL texture object from width x height palette indices, see tex_new_indexed(),
+ * returning its name.  Like tex_upload() this is usable from any thread sharing objects.
+ */
+unsigned tex_upload_indexed(int width, int height, const unsigned char *indices)
+{
+	unsigned	name;
+	GLint		bound;
+
+	assert(indices);
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+	glGenTextures(1, &name);
+	glBindTexture(GL_TEXTURE_2D, name);
+
+	/* the shader does the filtering after looking up the indices */
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width, height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, indices);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, bound);
+
+	return name;
+}
+
+
+/* wrap an already uploaded indexed texture name in a tex_t, which takes ownership of it */
+tex_t * tex_new_indexed_uploaded(unsigned name, int width, int height)
+{
+	tex_t	*tex;
+
+	tex_indexed_init();
+
+	tex = tex_wrap(name, width, height, (size_t)width * height);
+	tex->indexed = 1;
+
+	return tex;
+}
+
+
+/* create a tex from width x height ansr_view_palette[] indices, w/ANSR_VIEW_TRANSPARENT
+ * for transparent pixels.  It occupies a byte per pixel instead of four, and renders
+ * the same as the equivalent RGBA tex_new().
+ */
+tex_t * tex_new_indexed(int width, int height, const unsigned char *indices)
+{
+	assert(indices);
+
+	return tex_new_indexed_uploaded(tex_upload_indexed(width, height, indices), width, height);
+}
+
+
+/* wrap an already created width x height RGBA texture name holding premultiplied
+ * alpha in a tex_t, which takes ownership of it.  This is for textures getting
+ * rendered into rather than uploaded, see cache-node.c.
+ */
+tex_t * tex_new_premultiplied_uploaded(unsigned name, int width, int height)
+{
+	tex_t	*tex;
+
+	tex = tex_wrap(name, width, height, (size_t)width * height * 4);
+	tex->premultiplied = 1;
 
 	return tex;
 }
@@ -213,9 +1276,40 @@ tex_t * tex_free(tex_t *tex)
 
 	tex->refcnt--;
 	if (!tex->refcnt) {
-		glDeleteTextures(1, &tex->tex);
+		if (tex_batch.texels == tex)
+			tex_flush();
+
+		tex_resident -= tex->size;
+		if (tex->tex)
+			gl_state_delete_texture(tex->tex);
+		tex_free(tex->page);
 		free(tex);
 	}
 
 	return NULL;
 }
+
+
+/* the number of times any tex got its texels replaced by tex_reupload() so far,
+ * for whatever keeps renderings of textures around to tell when they're stale.
+ */
+unsigned tex_reuploads(void)
+{
+	return tex_reuploaded;
+}
+
+
+/* returns how many references are held on tex, for caches to tell when they hold the last one */
+unsigned tex_refcnt(const tex_t *tex)
+{
+	assert(tex);
+
+	return tex->refcnt;
+}
+
+
+/* returns the bytes of texture memory held by all live tex_t */
+size_t tex_resident_bytes(void)
+{
+	return tex_resident;
+}
@@ -17,14 +17,60 @@
 #ifndef _TEX_H
 #define _TEX_H
 
+#include <stddef.h>
 #include <stdint.h>
 
-typedef struct tex_t tex_t;
+#include "v2f.h"
+
+typedef struct bb2f_t bb2f_t;
 typedef struct m4f_t m4f_t;
+typedef struct tex_t tex_t;
+
+/* one of the sprites drawn by tex_render_instances(), optionally moving
+ * parametrically w/the time passed there.  The members after alpha are all 0
+ * for a still sprite.
+ */
+typedef struct tex_instance_t {
+	v2f_t	position;
+	v2f_t	scale;
+	float	rotation;	/* radians around z */
+	float	alpha;
+	float	swing;		/* rotation amplitude of the wave */
+	float	fade;		/* alpha change per unit of time */
+	v2f_t	velocity;	/* position change per unit of time */
+	v2f_t	wrap;		/* position axes w/a nonzero wrap are kept within -wrap..+wrap */
+	v2f_t	sway;		/* position amplitude of the wave, grows w/time */
+	float	rate, phase;	/* of the wave: sin(time * rate + phase) */
+} tex_instance_t;
 
 void tex_render(tex_t *tex, float alpha, m4f_t *projection_x, m4f_t *model_x);
+void tex_render_instances(tex_t *tex, float alpha, m4f_t *projection_x, unsigned projection_version, float time, unsigned n_instances, const tex_instance_t *instances);
+void tex_flush(void);
+bb2f_t * tex_track_extents(bb2f_t *extents);
+void tex_draw_stats(unsigned *res_draws, unsigned *res_sprites);
+unsigned tex_upload_lod(int width, int height, const unsigned char *buf, unsigned lod);
+unsigned tex_upload(int width, int height, const unsigned char *buf);
+tex_t * tex_new_uploaded(unsigned name, int width, int height, unsigned lod);
 tex_t * tex_new(int width, int height, const unsigned char *buf);
+void tex_reupload(tex_t *tex, unsigned name, unsigned lod);
+unsigned tex_lod(const tex_t *tex);
+void tex_size(const tex_t *tex, int *res_width, int *res_height);
+void tex_set_bounds(tex_t *tex, const bb2f_t *bounds);
+void tex_bounds(const tex_t *tex, bb2f_t *res_bounds);
+void tex_set_opaque(tex_t *tex, const bb2f_t *opaque);
+void tex_opaque(const tex_t *tex, bb2f_t *res_opaque);
+void tex_place(tex_t *tex, tex_t *page, const bb2f_t *uv);
+unsigned tex_upload_cells(int width, int height, const uint32_t *cells);
+tex_t * tex_new_cells_uploaded(unsigned name, int width, int height);
+tex_t * tex_new_cells(int width, int height, const uint32_t *cells);
+unsigned tex_upload_indexed(int width, int height, const unsigned char *indices);
+tex_t * tex_new_indexed_uploaded(unsigned name, int width, int height);
+tex_t * tex_new_indexed(int width, int height, const unsigned char *indices);
+tex_t * tex_new_premultiplied_uploaded(unsigned name, int width, int height);
 tex_t * tex_ref(tex_t *tex);
 tex_t * tex_free(tex_t *tex);
+unsigned tex_reuploads(void);
+unsigned tex_refcnt(const tex_t *tex);
+size_t tex_resident_bytes(void);
 
 #endif